@@ -1,8 +1,12 @@
 #ifndef ANY
 #define ANY
 
-#include <memory>
+#include <cstddef>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 
 class BadAnyCast : public std::bad_cast {
  public:
@@ -11,75 +15,183 @@ class BadAnyCast : public std::bad_cast {
   }
 };
 
-struct IHolder {
-  virtual ~IHolder() = default;
-  virtual IHolder* Clone() = 0;
+class Any;
+
+namespace detail {  // NOLINT
+
+union AnyStorage {
+  void* heap = nullptr;
+  alignas(void*) unsigned char buffer[3 * sizeof(void*)];
 };
 
-class Any;
+// each stored type has exactly one vtable, so its address doubles as the type tag
+struct AnyVTable {
+  void (*destroy)(AnyStorage& storage) noexcept;
+  void (*copy)(const AnyStorage& from, AnyStorage& to);
+  void (*move)(AnyStorage& from, AnyStorage& to) noexcept;
+};
 
+// small nothrow-movable values live in the buffer, everything else on the heap
 template <typename T>
-class AnyHolder : public IHolder {
-  template <typename U>
-  friend U& AnyCast(const Any& any);
-  T val_;
-
- public:
-  explicit AnyHolder(const T& val) : val_(val) {
+struct AnyTraits {
+  static constexpr bool kLocal = sizeof(T) <= sizeof(AnyStorage) && alignof(T) <= alignof(AnyStorage) &&
+                                 std::is_nothrow_move_constructible_v<T>;
+  static T* Get(const AnyStorage& storage) {
+    if constexpr (kLocal) {
+      return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(storage.buffer)));
+    } else {
+      return static_cast<T*>(storage.heap);
+    }
+  }
+  template <typename... Args>
+  static void Create(AnyStorage& storage, Args&&... args) {
+    if constexpr (kLocal) {
+      new (storage.buffer) T(std::forward<Args>(args)...);
+    } else {
+      storage.heap = new T(std::forward<Args>(args)...);
+    }
   }
-  IHolder* Clone() override {
-    return new AnyHolder(val_);
+  static void Destroy(AnyStorage& storage) noexcept {
+    if constexpr (kLocal) {
+      Get(storage)->~T();
+    } else {
+      delete Get(storage);
+    }
   }
+  static void Copy(const AnyStorage& from, AnyStorage& to) {
+    Create(to, *Get(from));
+  }
+  static void Move(AnyStorage& from, AnyStorage& to) noexcept {
+    if constexpr (kLocal) {
+      new (to.buffer) T(std::move(*Get(from)));
+      Get(from)->~T();
+    } else {
+      to.heap = from.heap;
+    }
+  }
+  static constexpr AnyVTable kVTable = {&Destroy, &Copy, &Move};
 };
 
+template <typename T>
+struct IsInPlaceType : std::false_type {};
+
+template <typename T>
+struct IsInPlaceType<std::in_place_type_t<T>> : std::true_type {};
+
+template <typename T>
+using EnableIfValue = std::enable_if_t<!std::is_same_v<std::decay_t<T>, Any> && !IsInPlaceType<std::decay_t<T>>::value>;
+
+}  // namespace detail
+
 class Any {
   template <typename U>
-  friend U& AnyCast(const Any& any);
-  std::unique_ptr<IHolder> ptr_ = nullptr;
+  friend U* AnyCast(Any* any) noexcept;
+  template <typename U>
+  friend const U* AnyCast(const Any* any) noexcept;
+  const detail::AnyVTable* vtable_ = nullptr;
+  detail::AnyStorage storage_;
 
  public:
-  Any() = default;
+  Any() noexcept {
+  }
   Any(const Any& other) {
-    ptr_.reset(other.ptr_->Clone());
+    if (other.vtable_) {
+      other.vtable_->copy(other.storage_, storage_);
+      vtable_ = other.vtable_;
+    }
   }
   Any(Any&& other) noexcept {
-    ptr_ = std::move(other.ptr_);
+    if (other.vtable_) {
+      other.vtable_->move(other.storage_, storage_);
+      vtable_ = other.vtable_;
+      other.vtable_ = nullptr;
+    }
+  }
+  template <typename T, typename = detail::EnableIfValue<T>>
+  Any(T&& val) {  // NOLINT
+    Emplace<std::decay_t<T>>(std::forward<T>(val));
   }
-  template <typename T>
-  Any(const T& val) {  // NOLINT
-    ptr_ = std::make_unique<AnyHolder<T>>(val);
+  template <typename T, typename... Args>
+  explicit Any(std::in_place_type_t<T>, Args&&... args) {
+    Emplace<T>(std::forward<Args>(args)...);
   }
-  template <typename T>
-  Any& operator=(const T& val) {
-    ptr_ = std::make_unique<AnyHolder<T>>(val);
+  ~Any() {
+    Reset();
+  }
+  template <typename T, typename = detail::EnableIfValue<T>>
+  Any& operator=(T&& val) {
+    Any tmp(std::forward<T>(val));
+    Swap(tmp);
     return *this;
   }
   Any& operator=(const Any& other) {
-    ptr_.reset(other.ptr_->Clone());
+    Any tmp(other);
+    Swap(tmp);
     return *this;
   }
   Any& operator=(Any&& other) noexcept {
-    ptr_.reset(other.ptr_.release());
+    if (this != &other) {
+      Reset();
+      if (other.vtable_) {
+        other.vtable_->move(other.storage_, storage_);
+        vtable_ = other.vtable_;
+        other.vtable_ = nullptr;
+      }
+    }
     return *this;
   }
   void Swap(Any& other) {
-    ptr_.swap(other.ptr_);
+    if (this != &other) {
+      Any tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+  template <typename T, typename... Args>
+  std::decay_t<T>& Emplace(Args&&... args) {
+    using Traits = detail::AnyTraits<std::decay_t<T>>;
+    Reset();
+    Traits::Create(storage_, std::forward<Args>(args)...);
+    vtable_ = &Traits::kVTable;
+    return *Traits::Get(storage_);
   }
   void Reset() {
-    ptr_.reset();
+    if (vtable_) {
+      vtable_->destroy(storage_);
+      vtable_ = nullptr;
+    }
   }
   bool HasValue() const {
-    return (ptr_ != nullptr);
+    return (vtable_ != nullptr);
   }
 };
 
+template <typename T>
+T* AnyCast(Any* any) noexcept {
+  using Traits = detail::AnyTraits<std::remove_cv_t<T>>;
+  if (!any || any->vtable_ != &Traits::kVTable) {
+    return nullptr;
+  }
+  return Traits::Get(any->storage_);
+}
+
+template <typename T>
+const T* AnyCast(const Any* any) noexcept {
+  return AnyCast<T>(const_cast<Any*>(any));
+}
+
 template <typename T>
 T& AnyCast(const Any& any) {
-  auto ptr = dynamic_cast<AnyHolder<T>*>(any.ptr_.get());
+  T* ptr = AnyCast<T>(const_cast<Any*>(&any));
   if (!ptr) {
     throw BadAnyCast{};
   }
-  return ptr->val_;
+  return *ptr;
+}
+
+template <typename T>
+std::remove_cv_t<T> AnyCast(Any&& any) {
+  return std::move(AnyCast<std::remove_cv_t<T>>(any));
 }
 
 #endif  // ANY
@@ -0,0 +1,95 @@
+#include <any>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "any.h"
+
+template <typename F>
+double Measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+using Large = std::array<int64_t, 8>;
+
+int64_t ValueOf(int64_t value) {
+  return value;
+}
+
+int64_t ValueOf(const Large& value) {
+  return value[0];
+}
+
+template <typename AnyT, typename T, typename Cast>
+void BenchAny(const std::string& name, size_t n, Cast&& cast, bool report = true) {
+  std::vector<AnyT> values;
+  values.reserve(n);
+  double construct_ms = Measure([&] {
+    for (size_t i = 0; i < n; ++i) {
+      T value{};
+      value = T{static_cast<int64_t>(i)};
+      values.emplace_back(value);
+    }
+  });
+  std::vector<AnyT> copies;
+  copies.reserve(n);
+  double copy_ms = Measure([&] {
+    for (const auto& value : values) {
+      copies.push_back(value);
+    }
+  });
+  int64_t sum = 0;
+  double cast_ms = Measure([&] {
+    for (const auto& value : copies) {
+      sum += ValueOf(cast(value));
+    }
+  });
+  if (!report) {
+    return;
+  }
+  std::cout << name << ": construct " << construct_ms << " ms, copy " << copy_ms << " ms, cast " << cast_ms
+            << " ms (" << sum << ")\n";
+}
+
+// passes a vector through a chain of Any hops, copying or moving it at every hop
+template <bool Move>
+void BenchHandoff(const std::string& name, size_t hops, size_t size) {
+  std::vector<int64_t> payload(size, 1);
+  int64_t sum = 0;
+  double ms = Measure([&] {
+    Any slot = payload;
+    for (size_t i = 0; i < hops; ++i) {
+      if constexpr (Move) {
+        Any next = AnyCast<std::vector<int64_t>>(std::move(slot));
+        slot = std::move(next);
+      } else {
+        Any next = AnyCast<std::vector<int64_t>>(slot);
+        slot = next;
+      }
+      sum += AnyCast<std::vector<int64_t>>(slot)[i % size];
+    }
+  });
+  std::cout << name << ": " << ms << " ms (" << sum << ")\n";
+}
+
+int main() {
+  const size_t n = 1 << 22;
+  BenchAny<std::any, Large>("", n, [](const std::any& any) -> const Large& { return *std::any_cast<Large>(&any); },
+                            false);
+  std::cout << "Small payload (int64_t), " << n << " values\n";
+  BenchAny<Any, int64_t>("  Any", n, [](const Any& any) { return AnyCast<int64_t>(any); });
+  BenchAny<std::any, int64_t>("  std::any", n, [](const std::any& any) { return std::any_cast<int64_t>(any); });
+  std::cout << "Large payload (64 bytes), " << n << " values\n";
+  BenchAny<Any, Large>("  Any", n, [](const Any& any) -> const Large& { return AnyCast<Large>(any); });
+  BenchAny<std::any, Large>("  std::any", n,
+                            [](const std::any& any) -> const Large& { return *std::any_cast<Large>(&any); });
+  std::cout << "Vector handoff, 4096 elements, " << n / 64 << " hops\n";
+  BenchHandoff<false>("  copy", n / 64, 4096);
+  BenchHandoff<true>("  move", n / 64, 4096);
+}
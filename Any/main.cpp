@@ -1,6 +1,8 @@
 #include <iostream>
 
+#include <array>
 #include <memory>
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -13,6 +15,43 @@
 #define STR2(x) # x
 #define REQUIRE_THROWS_AS(x, e) try { if(x) {}; throw std::runtime_error(STR(__LINE__) " error"); } catch (e& ex) {}
 
+struct Counted {
+  static int alive;
+  int value;
+  explicit Counted(int value) : value(value) {
+    ++alive;
+  }
+  Counted(const Counted& other) : value(other.value) {
+    ++alive;
+  }
+  Counted(Counted&& other) noexcept : value(other.value) {
+    ++alive;
+  }
+  ~Counted() {
+    --alive;
+  }
+};
+
+int Counted::alive = 0;
+
+struct ThrowingMove {
+  int value = 5;
+  ThrowingMove() = default;
+  ThrowingMove(const ThrowingMove&) = default;
+  ThrowingMove(ThrowingMove&& other) : value(other.value) {  // NOLINT
+  }
+};
+
+using SmallArray = std::array<void*, 3>;
+using LargeArray = std::array<void*, 4>;
+
+template <typename T>
+bool StoredInline(const Any& any) {
+  auto address = reinterpret_cast<const char*>(&AnyCast<T>(any));
+  auto begin = reinterpret_cast<const char*>(&any);
+  return begin <= address && address < begin + sizeof(Any);
+}
+
 int main() {
 
 #define TEST_CASE(a) std::cout << a << "\n";
@@ -109,4 +148,105 @@ TEST_CASE("BadAnyCast") {
   a = 11;
   REQUIRE_THROWS_AS(AnyCast<char*>(a), BadAnyCast);  // NOLINT
 }
+
+TEST_CASE("SmallObject") {
+  REQUIRE(sizeof(Any) == 4 * sizeof(void*));
+  {
+    Any a = 11;
+    Any b = &a;
+    Any c = SmallArray{&a, &b, nullptr};
+    Any d = LargeArray{};
+    Any e = ThrowingMove{};
+    REQUIRE(StoredInline<int>(a));
+    REQUIRE(StoredInline<Any*>(b));
+    REQUIRE(StoredInline<SmallArray>(c));
+    REQUIRE_FALSE(StoredInline<LargeArray>(d));
+    REQUIRE_FALSE(StoredInline<ThrowingMove>(e));
+    REQUIRE(AnyCast<ThrowingMove>(e).value == 5);
+
+    Any f = std::move(c);
+    REQUIRE_FALSE(c.HasValue());  // NOLINT
+    REQUIRE(AnyCast<SmallArray>(f)[1] == &b);
+    const LargeArray* heap_value = &AnyCast<LargeArray>(d);
+    Any g = std::move(d);
+    REQUIRE(&AnyCast<LargeArray>(g) == heap_value);
+    REQUIRE(AnyCast<LargeArray>(g)[3] == nullptr);
+  }
+
+  {
+    Any a = Counted(1);
+    Any b = std::string(100, 'x');
+    REQUIRE(Counted::alive == 1);
+    Any c = a;
+    REQUIRE(Counted::alive == 2);
+    AnyCast<Counted>(c).value = 2;
+    REQUIRE(AnyCast<Counted>(a).value == 1);
+    a.Swap(b);
+    REQUIRE(AnyCast<std::string>(a).size() == 100u);
+    REQUIRE(AnyCast<Counted>(b).value == 1);
+    b = a;
+    REQUIRE(Counted::alive == 1);
+    Any empty;
+    Any copy(empty);
+    REQUIRE_FALSE(copy.HasValue());
+    c = empty;
+    REQUIRE(Counted::alive == 0);
+  }
+}
+
+TEST_CASE("PointerCast") {
+  Any a;
+  REQUIRE(AnyCast<int>(&a) == nullptr);
+  REQUIRE(AnyCast<int>(static_cast<Any*>(nullptr)) == nullptr);
+
+  a = 11;
+  REQUIRE(AnyCast<long>(&a) == nullptr);
+  REQUIRE(AnyCast<unsigned>(&a) == nullptr);
+  *AnyCast<int>(&a) = 12;
+  REQUIRE(AnyCast<int>(a) == 12);
+  REQUIRE(AnyCast<const int>(&a) == AnyCast<int>(&a));
+
+  const Any b = std::string("abc");
+  const std::string* str = AnyCast<std::string>(&b);
+  REQUIRE(str != nullptr);
+  REQUIRE(*str == "abc");
+  REQUIRE(AnyCast<const char*>(&b) == nullptr);
+  REQUIRE(AnyCast<std::string>(static_cast<const Any*>(nullptr)) == nullptr);
+}
+
+TEST_CASE("MoveAndEmplace") {
+  std::vector<int> v(1000, 7);
+  const int* data = v.data();
+  Any a = std::move(v);
+  REQUIRE(AnyCast<std::vector<int>>(a).data() == data);
+
+  Any b = std::move(a);
+  std::vector<int> w = AnyCast<std::vector<int>>(std::move(b));
+  REQUIRE(w.data() == data);
+  REQUIRE(w.size() == 1000u);
+  REQUIRE(AnyCast<std::vector<int>>(b).empty());
+
+  b = std::move(w);
+  REQUIRE(AnyCast<std::vector<int>>(b).data() == data);
+
+  const Any c(std::in_place_type<std::string>, 5, 'x');
+  REQUIRE(AnyCast<std::string>(c) == "xxxxx");
+  Any d(std::in_place_type<Counted>, 3);
+  REQUIRE(Counted::alive == 1);
+  REQUIRE(AnyCast<Counted>(d).value == 3);
+
+  std::string& str = d.Emplace<std::string>(3, 'y');
+  REQUIRE(Counted::alive == 0);
+  str += 'z';
+  REQUIRE(AnyCast<std::string>(d) == "yyyz");
+  REQUIRE(d.Emplace<int>(4) == 4);
+  REQUIRE(AnyCast<int>(std::move(d)) == 4);
+
+  const char* text = "text";
+  Any e = text;
+  REQUIRE(AnyCast<const char*>(e) == text);
+  Any& ref = e;
+  Any f(ref);
+  REQUIRE(AnyCast<const char*>(f) == text);
+}
 }
@@ -0,0 +1,115 @@
+#ifndef ATOMIC_SHARED_PTR
+#define ATOMIC_SHARED_PTR
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "shared_ptr.h"
+
+// split reference count: the upper 16 bits of word_ count loads in flight on the current node,
+// and they are moved into Node::internal when the node is swapped out
+template <typename T>
+class AtomicSharedPtr {
+  static_assert(sizeof(void*) == sizeof(uint64_t), "AtomicSharedPtr packs a 48-bit pointer with a 16-bit count");
+  struct Node {
+    std::atomic<int64_t> internal{0};
+    SharedPtr<T> value;
+    explicit Node(SharedPtr<T>&& value) : value(std::move(value)) {
+    }
+  };
+  static constexpr unsigned kCountShift = 48;
+  static constexpr uint64_t kOne = uint64_t(1) << kCountShift;
+  static constexpr uint64_t kPointerMask = kOne - 1;
+  mutable std::atomic<uint64_t> word_{0};
+  static Node* NodeOf(uint64_t word) {
+    return reinterpret_cast<Node*>(word & kPointerMask);
+  }
+  static uint64_t Pack(SharedPtr<T>&& value) {
+    if (!value.counter_) {
+      return 0;
+    }
+    return reinterpret_cast<uint64_t>(new Node(std::move(value)));
+  }
+  static void Release(Node* node, int64_t count) {
+    if (node && node->internal.fetch_add(count, std::memory_order_acq_rel) + count == 0) {
+      delete node;
+    }
+  }
+  static void Retire(uint64_t word) {
+    Release(NodeOf(word), static_cast<int64_t>(word >> kCountShift));
+  }
+  static bool Holds(const Node* node, const SharedPtr<T>& value) {
+    if (!node) {
+      return !value.counter_;
+    }
+    return node->value.ptr_ == value.ptr_ && node->value.counter_ == value.counter_;
+  }
+  Node* Acquire() const {
+    return NodeOf(word_.fetch_add(kOne, std::memory_order_acquire));
+  }
+  void Unacquire(Node* node) const {
+    uint64_t word = word_.load(std::memory_order_relaxed);
+    while (NodeOf(word) == node) {
+      if (word_.compare_exchange_weak(word, word - kOne, std::memory_order_release, std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    Release(node, -1);
+  }
+
+ public:
+  AtomicSharedPtr() = default;
+  AtomicSharedPtr(SharedPtr<T> value) : word_(Pack(std::move(value))) {  // NOLINT
+  }
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+  ~AtomicSharedPtr() {
+    Retire(word_.load(std::memory_order_acquire));
+  }
+  bool IsLockFree() const {
+    return word_.is_lock_free();
+  }
+  SharedPtr<T> Load() const {
+    Node* node = Acquire();
+    SharedPtr<T> result;
+    if (node) {
+      result = node->value;
+    }
+    Unacquire(node);
+    return result;
+  }
+  void Store(SharedPtr<T> value) {
+    Retire(word_.exchange(Pack(std::move(value)), std::memory_order_acq_rel));
+  }
+  SharedPtr<T> Exchange(SharedPtr<T> value) {
+    uint64_t word = word_.exchange(Pack(std::move(value)), std::memory_order_acq_rel);
+    SharedPtr<T> result;
+    if (Node* node = NodeOf(word)) {
+      result = node->value;
+    }
+    Retire(word);
+    return result;
+  }
+  bool CompareExchange(SharedPtr<T>& expected, SharedPtr<T> desired) {
+    uint64_t fresh = Pack(std::move(desired));
+    while (true) {
+      Node* node = Acquire();
+      if (!Holds(node, expected)) {
+        expected = node ? node->value : SharedPtr<T>();
+        Unacquire(node);
+        Retire(fresh);
+        return false;
+      }
+      uint64_t word = word_.load(std::memory_order_relaxed);
+      while (NodeOf(word) == node) {
+        if (word_.compare_exchange_weak(word, fresh, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          Retire(word - kOne);
+          return true;
+        }
+      }
+      Release(node, -1);
+    }
+  }
+};
+#endif  // ATOMIC_SHARED_PTR
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shared_ptr.h"
+#include "atomic_shared_ptr.h"
+#include "intrusive_ptr.h"
+#include "deferred_deleter.h"
+#include "../Vector/vector.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+template <typename F>
+double Measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+struct Payload {
+  int64_t value;
+  int64_t padding[3];
+  explicit Payload(int64_t value) : value(value), padding{} {
+  }
+};
+
+struct IntrusivePayload : EnableRefCount<IntrusivePayload> {
+  int64_t value;
+  int64_t padding[3];
+  explicit IntrusivePayload(int64_t value) : value(value), padding{} {
+  }
+};
+
+struct GraphNode {
+  int64_t value = 0;
+  SharedPtr<GraphNode> children[4];
+};
+
+template <typename Factory>
+void BenchCreate(const std::string& name, Factory&& factory, size_t n) {
+  std::vector<SharedPtr<Payload>> ptrs;
+  ptrs.reserve(n);
+  double create_ms = Measure([&] {
+    for (size_t i = 0; i < n; ++i) {
+      ptrs.push_back(factory(static_cast<int64_t>(i)));
+    }
+  });
+  int64_t sum = 0;
+  double deref_ms = Measure([&] {
+    for (const auto& ptr : ptrs) {
+      SharedPtr<Payload> copy = ptr;
+      sum += copy->value;
+    }
+  });
+  double destroy_ms = Measure([&] { ptrs.clear(); });
+  std::cout << name << ": create " << create_ms << " ms, copy+deref " << deref_ms << " ms, destroy " << destroy_ms
+            << " ms (" << sum << ")\n";
+}
+
+void BenchContainer(size_t n) {
+  std::vector<SharedPtr<Payload>> objects;
+  for (size_t i = 0; i < n; ++i) {
+    objects.push_back(MakeShared<Payload>(static_cast<int64_t>((i * 7919) % n)));
+  }
+  Vector<SharedPtr<Payload>> v;
+  size_t before = allocations;
+  double grow_ms = Measure([&] {
+    for (const auto& ptr : objects) {
+      v.PushBack(ptr);
+    }
+  });
+  size_t grow_allocations = allocations - before;
+  before = allocations;
+  double sort_ms = Measure([&] {
+    std::sort(v.begin(), v.end(), [](const auto& lhs, const auto& rhs) { return lhs->value < rhs->value; });
+  });
+  std::cout << "Vector<SharedPtr>, " << n << " pointers: growth " << grow_ms << " ms, " << grow_allocations
+            << " allocations; sort " << sort_ms << " ms, " << allocations - before << " allocations\n";
+}
+
+void BenchContention(size_t threads, size_t iterations) {
+  const auto shared = MakeShared<Payload>(1);
+  std::vector<SharedPtr<Payload>> own;
+  for (size_t t = 0; t < threads; ++t) {
+    own.push_back(MakeShared<Payload>(1));
+  }
+  auto run = [&](bool contended) {
+    std::vector<std::thread> workers;
+    std::vector<int64_t> sums(threads);
+    double ms = Measure([&] {
+      for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+          const SharedPtr<Payload>& source = contended ? shared : own[t];
+          int64_t sum = 0;
+          for (size_t i = 0; i < iterations; ++i) {
+            SharedPtr<Payload> copy = source;
+            sum += copy->value;
+          }
+          sums[t] = sum;
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    });
+    return ms;
+  };
+  double own_ms = run(false);
+  double shared_ms = run(true);
+  std::cout << "  " << threads << " threads: same pointer " << shared_ms << " ms, own pointer " << own_ms << " ms\n";
+}
+
+template <typename Factory>
+void BenchScatteredCopy(const std::string& name, Factory&& factory, const std::vector<size_t>& order) {
+  using Ptr = decltype(factory(int64_t{}));
+  std::vector<Ptr> ptrs;
+  for (size_t i = 0; i < order.size(); ++i) {
+    ptrs.push_back(factory(static_cast<int64_t>(i)));
+  }
+  int64_t sum = 0;
+  double copy_ms = Measure([&] {
+    for (size_t index : order) {
+      Ptr copy = ptrs[index];
+      sum += copy->value;
+    }
+  });
+  double destroy_ms = Measure([&] {
+    for (size_t index : order) {
+      ptrs[index] = Ptr();
+    }
+  });
+  std::cout << name << ": copy+deref " << copy_ms << " ms, destroy " << destroy_ms << " ms (" << sum << ")\n";
+}
+
+template <typename Factory>
+SharedPtr<GraphNode> BuildGraph(Factory&& factory, size_t n) {
+  std::vector<SharedPtr<GraphNode>> nodes;
+  for (size_t i = 0; i < n; ++i) {
+    nodes.push_back(factory());
+  }
+  for (size_t i = 1; i < n; ++i) {
+    nodes[(i - 1) / 4]->children[(i - 1) % 4] = nodes[i];
+  }
+  return nodes[0];
+}
+
+void BenchRelease(size_t n, size_t batch) {
+  auto inline_root = BuildGraph([] { return MakeShared<GraphNode>(); }, n);
+  double inline_ms = Measure([&] { inline_root.Reset(); });
+  auto deferred_root = BuildGraph([] { return MakeDeferred<GraphNode>(); }, n);
+  double deferred_ms = Measure([&] { deferred_root.Reset(); });
+  double worst_batch_ms = 0;
+  double drain_ms = Measure([&] {
+    while (RetiredCount() > 0) {
+      worst_batch_ms = std::max(worst_batch_ms, Measure([&] { Drain(batch); }));
+    }
+  });
+  std::cout << "Release of a " << n << "-node graph: inline " << inline_ms << " ms; deferred " << deferred_ms
+            << " ms on release, drain " << drain_ms << " ms, worst batch of " << batch << " " << worst_batch_ms
+            << " ms\n";
+}
+
+template <typename Read>
+double RunReaders(size_t threads, size_t iterations, Read&& read) {
+  std::vector<std::thread> workers;
+  std::vector<int64_t> sums(threads);
+  return Measure([&] {
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        int64_t sum = 0;
+        for (size_t i = 0; i < iterations; ++i) {
+          sum += read()->value;
+        }
+        sums[t] = sum;
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  });
+}
+
+void BenchPublication(size_t threads, size_t iterations) {
+  AtomicSharedPtr<Payload> atomic(MakeShared<Payload>(1));
+  std::mutex mutex;
+  SharedPtr<Payload> guarded = MakeShared<Payload>(1);
+  double atomic_ms = RunReaders(threads, iterations, [&] { return atomic.Load(); });
+  double mutex_ms = RunReaders(threads, iterations, [&] {
+    std::lock_guard lock(mutex);
+    return guarded;
+  });
+  std::cout << "  " << threads << " threads: AtomicSharedPtr " << atomic_ms << " ms, mutex " << mutex_ms << " ms\n";
+}
+
+int main() {
+  const size_t n = 1 << 22;
+  std::cout << "Create/destroy, " << n << " pointers\n";
+  BenchCreate("  SharedPtr(new T)", [](int64_t i) { return SharedPtr<Payload>(new Payload(i)); }, n);
+  BenchCreate("  MakeShared", [](int64_t i) { return MakeShared<Payload>(i); }, n);
+  BenchContainer(n);
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(1));
+  BenchRelease(n / 4, 4096);
+  std::cout << "Scattered copy/destroy, " << n << " objects\n";
+  BenchScatteredCopy("  SharedPtr(new T)", [](int64_t i) { return SharedPtr<Payload>(new Payload(i)); }, order);
+  BenchScatteredCopy("  MakeShared", [](int64_t i) { return MakeShared<Payload>(i); }, order);
+  BenchScatteredCopy("  IntrusivePtr", [](int64_t i) { return MakeIntrusive<IntrusivePayload>(i); }, order);
+#ifndef SHARED_PTR_NON_ATOMIC
+  std::cout << "Copy/destroy contention, " << n << " copies per thread\n";
+  for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+    BenchContention(threads, n);
+  }
+  std::cout << "Snapshot loads, " << n << " per thread\n";
+  for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+    BenchPublication(threads, n);
+  }
+#endif
+}
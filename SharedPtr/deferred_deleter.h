@@ -0,0 +1,80 @@
+#ifndef DEFERRED_DELETER
+#define DEFERRED_DELETER
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "shared_ptr.h"
+
+namespace detail {  // NOLINT
+
+// objects released through DeferredDeleter wait here until their thread calls Drain;
+// draining pops in LIFO order, so children retired by a destructor are destroyed next
+// and deep chains are torn down iteratively instead of recursively
+class RetireList {
+  struct Retired {
+    void* ptr;
+    void (*destroy)(void*);
+  };
+  std::vector<Retired> retired_;
+
+ public:
+  RetireList() = default;
+  RetireList(const RetireList&) = delete;
+  RetireList& operator=(const RetireList&) = delete;
+  ~RetireList() {
+    Drain(SIZE_MAX);
+  }
+  static RetireList& Local() {
+    thread_local RetireList list;
+    return list;
+  }
+  template <typename T>
+  void Push(T* ptr) noexcept {
+    using Object = std::remove_cv_t<T>;
+    try {
+      retired_.push_back({const_cast<Object*>(ptr), [](void* object) { delete static_cast<Object*>(object); }});
+    } catch (...) {
+      delete ptr;
+    }
+  }
+  size_t Drain(size_t limit) {
+    size_t destroyed = 0;
+    while (!retired_.empty() && destroyed < limit) {
+      Retired retired = retired_.back();
+      retired_.pop_back();
+      retired.destroy(retired.ptr);
+      ++destroyed;
+    }
+    return destroyed;
+  }
+  size_t Size() const {
+    return retired_.size();
+  }
+};
+
+}  // namespace detail
+
+template <typename T>
+struct DeferredDeleter {
+  void operator()(T* ptr) const noexcept {
+    detail::RetireList::Local().Push(ptr);
+  }
+};
+
+template <typename T, typename... Args>
+SharedPtr<T> MakeDeferred(Args&&... args) {
+  return SharedPtr<T>(new T(std::forward<Args>(args)...), DeferredDeleter<T>());
+}
+
+inline size_t Drain(size_t limit = SIZE_MAX) {
+  return detail::RetireList::Local().Drain(limit);
+}
+
+inline size_t RetiredCount() {
+  return detail::RetireList::Local().Size();
+}
+#endif  // DEFERRED_DELETER
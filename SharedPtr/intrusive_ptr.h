@@ -0,0 +1,166 @@
+#ifndef INTRUSIVE_PTR
+#define INTRUSIVE_PTR
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "shared_ptr.h"
+
+template <typename T>
+class IntrusivePtr;
+
+// word_ holds either 2 * count (low bit clear) or a pointer to the weak block (low bit set);
+// the block is allocated on the first Weak() call and owns the count from then on
+template <typename T, bool Atomic = true>
+class EnableRefCount {
+  friend class IntrusivePtr<T>;
+  struct WeakBlock : detail::Counter {
+    T* object;
+    WeakBlock(T* object, size_t strong) : detail::Counter(strong), object(object) {
+    }
+    void DestroyObject() noexcept override {
+      delete object;
+    }
+    void DestroyCounter() noexcept override {
+      delete this;
+    }
+  };
+  static constexpr uintptr_t kBlockTag = 1;
+  mutable std::conditional_t<Atomic, std::atomic<uintptr_t>, uintptr_t> word_{0};
+  uintptr_t LoadWord() const {
+    if constexpr (Atomic) {
+      return word_.load(std::memory_order_acquire);
+    } else {
+      return word_;
+    }
+  }
+  bool ExchangeWord(uintptr_t& expected, uintptr_t desired) const {
+    if constexpr (Atomic) {
+      return word_.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+    } else {
+      word_ = desired;
+      return true;
+    }
+  }
+  static WeakBlock* BlockOf(uintptr_t word) {
+    return reinterpret_cast<WeakBlock*>(word & ~kBlockTag);
+  }
+  void AddRef() const {
+    uintptr_t word = LoadWord();
+    while (!(word & kBlockTag)) {
+      if (ExchangeWord(word, word + 2)) {
+        return;
+      }
+    }
+    BlockOf(word)->strong.Increment();
+  }
+  void Release() const {
+    uintptr_t word = LoadWord();
+    while (!(word & kBlockTag)) {
+      if (ExchangeWord(word, word - 2)) {
+        if (word == 2) {
+          delete static_cast<const T*>(this);
+        }
+        return;
+      }
+    }
+    WeakBlock* block = BlockOf(word);
+    if (block->strong.Decrement() == 0) {
+      block->DestroyObject();
+      if (block->weak.Decrement() == 0) {
+        block->DestroyCounter();
+      }
+    }
+  }
+  WeakBlock* Block(const detail::Site& site) const {
+    uintptr_t word = LoadWord();
+    while (!(word & kBlockTag)) {
+      auto block = new WeakBlock(const_cast<T*>(static_cast<const T*>(this)), word / 2);
+      if (ExchangeWord(word, reinterpret_cast<uintptr_t>(block) | kBlockTag)) {
+        detail::Track<T>(block, site);
+        return block;
+      }
+      delete block;
+    }
+    return BlockOf(word);
+  }
+  size_t UseCount() const {
+    uintptr_t word = LoadWord();
+    return (word & kBlockTag ? BlockOf(word)->strong.Load() : word / 2);
+  }
+
+ protected:
+  EnableRefCount() = default;
+  EnableRefCount(const EnableRefCount&) {
+  }
+  EnableRefCount& operator=(const EnableRefCount&) {
+    return *this;
+  }
+  ~EnableRefCount() = default;
+};
+
+template <typename T>
+class IntrusivePtr {
+  T* ptr_ = nullptr;
+
+ public:
+  IntrusivePtr() = default;
+  IntrusivePtr(T* ptr) : ptr_(ptr) {  // NOLINT
+    if (ptr_) {
+      ptr_->AddRef();
+    }
+  }
+  IntrusivePtr(const IntrusivePtr& other) : IntrusivePtr(other.ptr_) {
+  }
+  IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(other.ptr_) {
+    other.ptr_ = nullptr;
+  }
+  ~IntrusivePtr() {
+    if (ptr_) {
+      ptr_->Release();
+    }
+  }
+  IntrusivePtr& operator=(const IntrusivePtr& other) {
+    IntrusivePtr tmp(other);
+    Swap(tmp);
+    return *this;
+  }
+  IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+    IntrusivePtr tmp(std::move(other));
+    Swap(tmp);
+    return *this;
+  }
+  void Reset(T* ptr = nullptr) {
+    IntrusivePtr tmp(ptr);
+    Swap(tmp);
+  }
+  void Swap(IntrusivePtr& other) {
+    std::swap(ptr_, other.ptr_);
+  }
+  size_t UseCount() const {
+    return (ptr_ ? ptr_->UseCount() : 0);
+  }
+  WeakPtr<T> Weak(const detail::Site& site = detail::Site::Here()) const {
+    return (ptr_ ? WeakPtr<T>(ptr_, ptr_->Block(site)) : WeakPtr<T>());
+  }
+  T* Get() const {
+    return ptr_;
+  }
+  T& operator*() const {
+    return *ptr_;
+  }
+  T* operator->() const {
+    return ptr_;
+  }
+  explicit operator bool() const {
+    return ptr_ != nullptr;
+  }
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusive(Args&&... args) {
+  return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+#endif  // INTRUSIVE_PTR
@@ -1,11 +1,21 @@
+#include <atomic>
 #include <iostream>
 
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
 #include "shared_ptr.h"
 #include "shared_ptr.h"  // check include guards
+#include "atomic_shared_ptr.h"
+#include "atomic_shared_ptr.h"  // check include guards
+#include "intrusive_ptr.h"
+#include "intrusive_ptr.h"  // check include guards
+#include "deferred_deleter.h"
+#include "deferred_deleter.h"  // check include guards
 
 #define REQUIRE(X) if(!(X)) { std::cout << __LINE__ << " error\n"; }
 #define REQUIRE_FALSE(X) if((X)) { std::cout << __LINE__ << " error\n"; }
@@ -13,6 +23,77 @@
 #define STR2(x) # x
 #define REQUIRE_THROWS_AS(x, e) try { if(x) {}; throw std::runtime_error(STR(__LINE__) " error"); } catch (e& ex) {}
 
+struct Tracked {
+  static std::atomic<int> alive;
+  int value;
+  explicit Tracked(int value) : value(value) {
+    ++alive;
+  }
+  Tracked(const Tracked& other) : value(other.value) {
+    ++alive;
+  }
+  ~Tracked() {
+    --alive;
+  }
+};
+
+std::atomic<int> Tracked::alive{0};
+
+template <bool Atomic>
+struct Counted : EnableRefCount<Counted<Atomic>, Atomic> {
+  Tracked tracked;
+  explicit Counted(int value) : tracked(value) {
+  }
+};
+
+struct Base {
+  virtual ~Base() = default;
+  int id = 1;
+};
+
+struct Derived : Base {
+  Tracked tracked{2};
+};
+
+struct PoolDeleter {
+  std::vector<Tracked*>* pool;
+  void operator()(Tracked* ptr) const {
+    pool->push_back(ptr);
+  }
+};
+
+struct Session : EnableSharedFromThis<Session> {
+  Tracked tracked{3};
+};
+
+struct ChainNode {
+  Tracked tracked{0};
+  SharedPtr<ChainNode> next;
+};
+
+struct SelfObserver {
+  WeakPtr<SelfObserver> self;
+};
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;  // NOLINT
+  size_t* allocations;
+  explicit CountingAllocator(size_t* allocations) : allocations(allocations) {
+  }
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other) : allocations(other.allocations) {  // NOLINT
+  }
+  T* allocate(size_t n) {  // NOLINT
+    ++*allocations;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* ptr, size_t n) {  // NOLINT
+    --*allocations;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+};
+
 int main() {
 
 #define TEST_CASE(a, b) std::cout << a << " " << b << '\n';
@@ -422,5 +503,393 @@ TEST_CASE("MakeShared", "[SharedPtr]") {
   }
 }
 
+TEST_CASE("AllocateShared", "[SharedPtr]") {
+  size_t allocations = 0;
+  {
+    const auto ptr = AllocateShared<std::vector<int>>(CountingAllocator<int>(&allocations), 3, 5);
+    REQUIRE(allocations == 1u);
+    REQUIRE(*ptr == std::vector<int>(3, 5));
+    const WeakPtr<std::vector<int>> weak(ptr);
+    auto copy = ptr;
+    REQUIRE(ptr.UseCount() == 2);
+    REQUIRE(allocations == 1u);
+  }
+  REQUIRE(allocations == 0u);
+
+  WeakPtr<std::vector<int>> weak;
+  {
+    const auto ptr = AllocateShared<std::vector<int>>(CountingAllocator<int>(&allocations));
+    weak = ptr;
+  }
+  REQUIRE(weak.Expired());
+  REQUIRE(allocations == 1u);
+  weak.Reset();
+  REQUIRE(allocations == 0u);
+}
+
+#endif
+
+#ifdef ATOMIC_REFCOUNT_IMPLEMENTED
+
+#ifndef SHARED_PTR_NON_ATOMIC
+TEST_CASE("Threads", "[SharedPtr]") {
+  const SharedPtr<std::vector<int>> ptr(new std::vector<int>(3, 5));
+  const WeakPtr<std::vector<int>> weak(ptr);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 100000; ++i) {
+        SharedPtr<std::vector<int>> copy = ptr;
+        auto locked = weak.Lock();
+        if (copy->size() != 3 || !locked) {
+          std::cout << __LINE__ << " error\n";
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(ptr.UseCount() == 1);
+  REQUIRE(weak.UseCount() == 1);
+}
+#endif
+
+TEST_CASE("SelfWeak", "[SharedPtr]") {
+  {
+    SharedPtr<SelfObserver> ptr(new SelfObserver);
+    ptr->self = ptr;
+    REQUIRE(ptr.UseCount() == 1);
+  }
+  {
+    auto ptr = MakeShared<SelfObserver>();
+    ptr->self = ptr;
+    REQUIRE(ptr->self.Lock().Get() == ptr.Get());
+  }
+}
+
+#endif
+
+TEST_CASE("AtomicSharedPtr", "[AtomicSharedPtr]") {
+  {
+    AtomicSharedPtr<Tracked> atomic;
+    REQUIRE(atomic.IsLockFree());
+    REQUIRE(!atomic.Load());
+    atomic.Store(MakeShared<Tracked>(1));
+    auto first = atomic.Load();
+    REQUIRE(first->value == 1);
+    REQUIRE(first.UseCount() == 2);
+    auto old = atomic.Exchange(MakeShared<Tracked>(2));
+    REQUIRE(old.Get() == first.Get());
+    REQUIRE(atomic.Load()->value == 2);
+
+    SharedPtr<Tracked> expected = first;
+    REQUIRE(!atomic.CompareExchange(expected, MakeShared<Tracked>(3)));
+    REQUIRE(expected->value == 2);
+    REQUIRE(atomic.CompareExchange(expected, MakeShared<Tracked>(3)));
+    REQUIRE(atomic.Load()->value == 3);
+    expected = SharedPtr<Tracked>();
+    REQUIRE(!atomic.CompareExchange(expected, nullptr));
+    REQUIRE(expected->value == 3);
+    REQUIRE(atomic.CompareExchange(expected, nullptr));
+    REQUIRE(!atomic.Load());
+    first.Reset();
+    old.Reset();
+    expected.Reset();
+    REQUIRE(Tracked::alive == 0);
+    atomic.Store(MakeShared<Tracked>(4));
+  }
+  REQUIRE(Tracked::alive == 0);
+
+#ifndef SHARED_PTR_NON_ATOMIC
+  {
+    AtomicSharedPtr<Tracked> atomic(MakeShared<Tracked>(0));
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+      readers.emplace_back([&] {
+        int last = 0;
+        while (!stop.load()) {
+          auto snapshot = atomic.Load();
+          if (snapshot->value < last) {
+            std::cout << __LINE__ << " error\n";
+          }
+          last = snapshot->value;
+        }
+      });
+    }
+    for (int i = 1; i <= 20000; ++i) {
+      if (i % 2) {
+        atomic.Store(MakeShared<Tracked>(i));
+      } else {
+        auto expected = atomic.Load();
+        atomic.CompareExchange(expected, MakeShared<Tracked>(i));
+      }
+    }
+    stop = true;
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    REQUIRE(atomic.Load()->value == 20000);
+  }
+  REQUIRE(Tracked::alive == 0);
+#endif
+}
+
+TEST_CASE("IntrusivePtr", "[IntrusivePtr]") {
+  {
+    IntrusivePtr<Counted<true>> a = MakeIntrusive<Counted<true>>(1);
+    REQUIRE(sizeof(a) == sizeof(void*));
+    REQUIRE(a.UseCount() == 1);
+    IntrusivePtr<Counted<true>> b = a;
+    IntrusivePtr<Counted<true>> c(a.Get());
+    REQUIRE(a.UseCount() == 3);
+    IntrusivePtr<Counted<true>> d = std::move(b);
+    REQUIRE(!b);
+    REQUIRE(d.UseCount() == 3);
+    c.Reset();
+    d.Swap(c);
+    REQUIRE(!d);
+    REQUIRE(c->tracked.value == 1);
+    REQUIRE(a.UseCount() == 2);
+  }
+  REQUIRE(Tracked::alive == 0);
+
+  {
+    IntrusivePtr<Counted<false>> a(new Counted<false>(2));
+    auto b = a;
+    REQUIRE(b.UseCount() == 2);
+    a = IntrusivePtr<Counted<false>>();
+    REQUIRE(b.UseCount() == 1);
+    REQUIRE(Tracked::alive == 1);
+  }
+  REQUIRE(Tracked::alive == 0);
+
+  WeakPtr<Counted<true>> weak;
+  {
+    auto a = MakeIntrusive<Counted<true>>(3);
+    auto b = a;
+    weak = a.Weak();
+    REQUIRE(weak.UseCount() == 2);
+    REQUIRE(a.UseCount() == 2);
+    auto shared = weak.Lock();
+    REQUIRE(shared.Get() == a.Get());
+    REQUIRE(a.UseCount() == 3);
+    a.Reset();
+    b.Reset();
+    REQUIRE(!weak.Expired());
+    REQUIRE(Tracked::alive == 1);
+    IntrusivePtr<Counted<true>> back(shared.Get());
+    shared = SharedPtr<Counted<true>>();
+    REQUIRE(back.UseCount() == 1);
+    REQUIRE(back.Weak().UseCount() == 1);
+  }
+  REQUIRE(weak.Expired());
+  REQUIRE(!weak.Lock());
+  REQUIRE(Tracked::alive == 0);
+
+#ifndef SHARED_PTR_NON_ATOMIC
+  {
+    auto root = MakeIntrusive<Counted<true>>(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < 20000; ++i) {
+          IntrusivePtr<Counted<true>> copy = root;
+          if (t == 0 && i == 10000) {
+            auto shared = copy.Weak().Lock();
+            if (!shared) {
+              std::cout << __LINE__ << " error\n";
+            }
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(root.UseCount() == 1);
+  }
+  REQUIRE(Tracked::alive == 0);
+#endif
+}
+
+#ifdef SHARED_FROM_THIS_IMPLEMENTED
+
+TEST_CASE("Aliasing", "[SharedPtr]") {
+  {
+    auto pair = MakeShared<std::pair<Tracked, Tracked>>(Tracked(1), Tracked(2));
+    SharedPtr<Tracked> second(pair, &pair->second);
+    REQUIRE(second->value == 2);
+    REQUIRE(pair.UseCount() == 2);
+    pair.Reset();
+    REQUIRE(Tracked::alive == 2);
+    REQUIRE(second.UseCount() == 1);
+    SharedPtr<Tracked> moved(std::move(second), second.Get());
+    REQUIRE(!second);
+    REQUIRE(moved->value == 2);
+  }
+  REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("Converting", "[SharedPtr]") {
+  {
+    SharedPtr<Base> base = new Derived;
+    REQUIRE(base->id == 1);
+    SharedPtr<Derived> derived = MakeShared<Derived>();
+    SharedPtr<Base> copy = derived;
+    REQUIRE(derived.UseCount() == 2);
+    SharedPtr<const Base> moved = std::move(derived);
+    REQUIRE(!derived);
+    REQUIRE(copy.UseCount() == 2);
+  }
+  REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("Deleter", "[SharedPtr]") {
+  std::vector<Tracked*> pool;
+  {
+    SharedPtr<Tracked> ptr(new Tracked(5), PoolDeleter{&pool});
+    auto copy = ptr;
+    ptr.Reset(new Tracked(6), PoolDeleter{&pool});
+    REQUIRE(pool.empty());
+  }
+  REQUIRE(pool.size() == 2u);
+  REQUIRE(Tracked::alive == 2);
+  for (Tracked* ptr : pool) {
+    delete ptr;
+  }
+  int closed = 0;
+  {
+    int handle = 7;
+    SharedPtr<int> ptr(&handle, [&closed](int*) { ++closed; });
+    REQUIRE(*ptr == 7);
+  }
+  REQUIRE(closed == 1);
+}
+
+TEST_CASE("SharedFromThis", "[SharedPtr]") {
+  {
+    SharedPtr<Session> ptr(new Session);
+    auto self = ptr->SharedFromThis();
+    REQUIRE(self.Get() == ptr.Get());
+    REQUIRE(ptr.UseCount() == 2);
+    const Session& session = *ptr;
+    SharedPtr<const Session> const_self = session.SharedFromThis();
+    REQUIRE(ptr.UseCount() == 3);
+    REQUIRE(ptr->WeakFromThis().UseCount() == 3);
+  }
+  REQUIRE(Tracked::alive == 0);
+  {
+    auto ptr = MakeShared<Session>();
+    REQUIRE(ptr->SharedFromThis().Get() == ptr.Get());
+    REQUIRE(ptr.UseCount() == 1);
+  }
+  REQUIRE(Tracked::alive == 0);
+  {
+    int deleted = 0;
+    SharedPtr<Session> null_session(static_cast<Session*>(nullptr), [&deleted](Session*) { ++deleted; });
+    REQUIRE(null_session.Get() == nullptr);
+    null_session.Reset(static_cast<Session*>(nullptr), [&deleted](Session*) { ++deleted; });
+    REQUIRE(deleted == 1);
+  }
+  Session orphan;
+  REQUIRE(orphan.WeakFromThis().Expired());
+  REQUIRE_THROWS_AS(orphan.SharedFromThis(), BadWeakPtr);
+}
+
+#endif
+
+TEST_CASE("Deferred", "[SharedPtr]") {
+  {
+    auto ptr = MakeDeferred<Tracked>(1);
+    auto copy = ptr;
+  }
+  REQUIRE(Tracked::alive == 1);
+  REQUIRE(RetiredCount() == 1u);
+  REQUIRE(Drain() == 1u);
+  REQUIRE(Tracked::alive == 0);
+
+  const int length = 200000;
+  {
+    SharedPtr<ChainNode> head;
+    for (int i = 0; i < length; ++i) {
+      auto node = MakeDeferred<ChainNode>();
+      node->next = std::move(head);
+      head = std::move(node);
+    }
+  }
+  REQUIRE(Tracked::alive == length);
+  REQUIRE(RetiredCount() == 1u);
+  REQUIRE(Drain(10) == 10u);
+  REQUIRE(Tracked::alive == length - 10);
+  REQUIRE(RetiredCount() == 1u);
+  REQUIRE(Drain() == static_cast<size_t>(length - 10));
+  REQUIRE(Tracked::alive == 0);
+  REQUIRE(Drain() == 0u);
+
+  std::thread([] { MakeDeferred<Tracked>(2); }).join();
+  REQUIRE(Tracked::alive == 0);
+}
+
+#ifdef SHARED_PTR_DEBUG
+
+TEST_CASE("Registry", "[SharedPtr]") {
+  auto count_of = [](const SharedPtrReport& report, const std::string& type) {
+    for (const auto& stats : report.types) {
+      if (stats.type == type) {
+        return stats.live;
+      }
+    }
+    return size_t(0);
+  };
+  size_t before = CollectSharedPtrReport().live;
+  {
+    SharedPtr<Tracked> first(new Tracked(1));
+    WeakPtr<Tracked> weak = first;
+    std::vector<SharedPtr<Tracked>> rest;
+    for (int i = 0; i < 100; ++i) {
+      rest.push_back(MakeShared<Tracked>(i));
+    }
+    auto copy = rest[0];
+    auto report = CollectSharedPtrReport(3);
+    REQUIRE(report.live == before + 101);
+    REQUIRE(count_of(report, "Tracked") == 101u);
+    REQUIRE(report.oldest.size() == 3u);
+    REQUIRE(report.strong_histogram.size() >= 3u);
+    REQUIRE(report.strong_histogram[1] >= 100u);
+    REQUIRE(report.strong_histogram[2] >= 1u);
+    REQUIRE(report.weak_histogram[1] >= 1u);
+    bool found = false;
+    for (const auto& survivor : CollectSharedPtrReport(before + 1).oldest) {
+      if (survivor.type == "Tracked" && survivor.site.file) {
+        found = found || (std::string(survivor.site.file).find("main.cpp") != std::string::npos && survivor.weak == 1);
+      }
+    }
+    REQUIRE(found);
+    std::ostringstream out;
+    DumpSharedPtrReport(out);
+    REQUIRE(out.str().find("Tracked: live 101, peak 101") != std::string::npos);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([] {
+        for (int i = 0; i < 2000; ++i) {
+          auto ptr = MakeShared<Tracked>(i);
+          if (i % 100 == 0) {
+            CollectSharedPtrReport();
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  auto report = CollectSharedPtrReport();
+  REQUIRE(report.live == before);
+  REQUIRE(count_of(report, "Tracked") == 0u);
+}
+
 #endif
 }
@@ -1,7 +1,13 @@
 #ifndef SHAREDPTR
 #define SHAREDPTR
+#define MAKE_SHARED_IMPLEMENTED
+#define ATOMIC_REFCOUNT_IMPLEMENTED
 
+#include <atomic>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 class BadWeakPtr : public std::runtime_error {
@@ -10,44 +16,265 @@ class BadWeakPtr : public std::runtime_error {
   }
 };
 
+namespace detail {  // NOLINT
+
+class AtomicRefCount {
+  std::atomic<size_t> count_;
+
+ public:
+  explicit AtomicRefCount(size_t count) : count_(count) {
+  }
+  void Increment() noexcept {
+    count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  size_t Decrement() noexcept {
+    return count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+  bool IncrementIfNotZero() noexcept {
+    size_t count = count_.load(std::memory_order_relaxed);
+    while (count != 0) {
+      if (count_.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  size_t Load() const noexcept {
+    return count_.load(std::memory_order_acquire);
+  }
+};
+
+class PlainRefCount {
+  size_t count_;
+
+ public:
+  explicit PlainRefCount(size_t count) : count_(count) {
+  }
+  void Increment() noexcept {
+    ++count_;
+  }
+  size_t Decrement() noexcept {
+    return --count_;
+  }
+  bool IncrementIfNotZero() noexcept {
+    if (count_ == 0) {
+      return false;
+    }
+    ++count_;
+    return true;
+  }
+  size_t Load() const noexcept {
+    return count_;
+  }
+};
+
+#ifdef SHARED_PTR_NON_ATOMIC
+using RefCount = PlainRefCount;
+#else
+using RefCount = AtomicRefCount;
+#endif
+
+}  // namespace detail
+
+#ifdef SHARED_PTR_DEBUG
+#include "shared_ptr_debug.h"
+#define SHARED_PTR_NOINLINE __attribute__((noinline))
+#else
+#define SHARED_PTR_NOINLINE
+
+namespace detail {  // NOLINT
+
+struct Site {
+  static Site Here() {
+    return {};
+  }
+  static Site Caller(const void*) {
+    return {};
+  }
+};
+
+template <typename T, typename C>
+void Track(C*, const Site&) {
+}
+
+}  // namespace detail
+#endif
+
+namespace detail {  // NOLINT
+
+// weak also holds one reference on behalf of all strong owners
+struct Counter {
+  RefCount strong;
+  RefCount weak{1};
+  explicit Counter(size_t strong = 1) : strong(strong) {
+  }
+#ifdef SHARED_PTR_DEBUG
+  uint32_t debug_slot = Registry::kNoSlot;
+  virtual ~Counter() {
+    Untrack(debug_slot);
+  }
+#else
+  virtual ~Counter() = default;
+#endif
+  virtual void DestroyObject() noexcept = 0;
+  virtual void DestroyCounter() noexcept = 0;
+};
+
+template <typename T, typename Deleter = std::default_delete<T>>
+struct PointerCounter : Counter {
+  T* ptr;
+  Deleter deleter;
+  PointerCounter(T* ptr, Deleter deleter) : ptr(ptr), deleter(std::move(deleter)) {
+  }
+  void DestroyObject() noexcept override {
+    deleter(ptr);
+  }
+  void DestroyCounter() noexcept override {
+    delete this;
+  }
+};
+
+template <typename T, typename Alloc>
+struct InplaceCounter : Counter {
+  using ObjectAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+  using CounterAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<InplaceCounter>;
+  ObjectAlloc alloc;
+  alignas(T) unsigned char storage[sizeof(T)];
+  template <typename... Args>
+  explicit InplaceCounter(const Alloc& alloc, Args&&... args) : alloc(alloc) {
+    std::allocator_traits<ObjectAlloc>::construct(this->alloc, Get(), std::forward<Args>(args)...);
+  }
+  T* Get() noexcept {
+    return std::launder(reinterpret_cast<T*>(storage));
+  }
+  void DestroyObject() noexcept override {
+    std::allocator_traits<ObjectAlloc>::destroy(alloc, Get());
+  }
+  void DestroyCounter() noexcept override {
+    CounterAlloc counter_alloc(alloc);
+    this->~InplaceCounter();
+    std::allocator_traits<CounterAlloc>::deallocate(counter_alloc, this, 1);
+  }
+};
+
+struct SharedFromThisTag {};
+
+}  // namespace detail
+
 template <typename T>
 class WeakPtr;
 
+template <typename T>
+class SharedPtr;
+
+template <typename T>
+class AtomicSharedPtr;
+
+template <typename T>
+class EnableSharedFromThis;
+
+template <typename T>
+class IntrusivePtr;
+
+namespace detail {  // NOLINT
+
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateSharedAt(const Site& site, const Alloc& alloc, Args&&... args);
+
+}  // namespace detail
+
 template <typename T>
 class SharedPtr {
+  template <typename U>
+  friend class SharedPtr;
   friend class WeakPtr<T>;
-  struct Counter {
-    size_t strong = 1;
-    size_t weak = 0;
-  };
+  friend class AtomicSharedPtr<T>;
+  template <typename U, typename Alloc, typename... Args>
+  friend SharedPtr<U> detail::AllocateSharedAt(const detail::Site& site, const Alloc& alloc, Args&&... args);
   T* ptr_ = nullptr;
-  Counter* counter_ = nullptr;
+  detail::Counter* counter_ = nullptr;
+  SharedPtr(detail::Counter* counter, T* ptr) : ptr_(ptr), counter_(counter) {
+  }
+  template <typename U, typename Deleter>
+  void Own(U* ptr, Deleter deleter, const detail::Site& site) {
+    try {
+      counter_ = new detail::PointerCounter<U, Deleter>(ptr, deleter);
+    } catch (...) {
+      deleter(ptr);
+      throw;
+    }
+    detail::Track<U>(counter_, site);
+    EnableWeakThis(ptr);
+  }
+  template <typename U>
+  void EnableWeakThis(U* ptr) {
+    if constexpr (std::is_base_of_v<detail::SharedFromThisTag, U>) {
+      if (ptr == nullptr) {
+        return;
+      }
+      using Base = typename U::SharedFromThisType;
+      auto& weak_this = static_cast<const EnableSharedFromThis<Base>*>(ptr)->weak_this_;
+      if (weak_this.Expired()) {
+        weak_this = WeakPtr<Base>(const_cast<std::remove_cv_t<U>*>(ptr), counter_);
+      }
+    }
+  }
 
  public:
-  SharedPtr() : counter_(new Counter) {
+  SharedPtr() = default;
+  SharedPtr(T* ptr, const detail::Site& site = detail::Site::Here()) : ptr_(ptr) {  // NOLINT
+    if (ptr_) {
+      Own(ptr, std::default_delete<T>(), site);
+    }
+  }
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  SharedPtr(U* ptr, const detail::Site& site = detail::Site::Here()) : ptr_(ptr) {  // NOLINT
+    if (ptr_) {
+      Own(ptr, std::default_delete<U>(), site);
+    }
   }
-  SharedPtr(T* ptr) : ptr_(ptr), counter_(new Counter) {  // NOLINT
+  template <typename U, typename Deleter, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  SharedPtr(U* ptr, Deleter deleter, const detail::Site& site = detail::Site::Here()) : ptr_(ptr) {
+    Own(ptr, std::move(deleter), site);
+  }
+  template <typename U>
+  SharedPtr(const SharedPtr<U>& other, T* ptr) : ptr_(ptr), counter_(other.counter_) {
+    if (counter_) {
+      counter_->strong.Increment();
+    }
+  }
+  template <typename U>
+  SharedPtr(SharedPtr<U>&& other, T* ptr) noexcept : ptr_(ptr), counter_(other.counter_) {
+    other.ptr_ = nullptr;
+    other.counter_ = nullptr;
+  }
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  SharedPtr(const SharedPtr<U>& other) : SharedPtr(other, other.ptr_) {  // NOLINT
+  }
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+  SharedPtr(SharedPtr<U>&& other) noexcept : SharedPtr(std::move(other), other.ptr_) {  // NOLINT
   }
   SharedPtr(const SharedPtr& other) {
     ptr_ = other.ptr_;
     counter_ = other.counter_;
-    ++counter_->strong;
+    if (counter_) {
+      counter_->strong.Increment();
+    }
   }
   ~SharedPtr() {
-    if (--counter_->strong == 0) {
-      if (counter_->weak == 0) {
-        delete counter_;
+    if (counter_ && counter_->strong.Decrement() == 0) {
+      counter_->DestroyObject();
+      if (counter_->weak.Decrement() == 0) {
+        counter_->DestroyCounter();
       }
-      delete ptr_;
     }
   }
   explicit SharedPtr(const WeakPtr<T>& weak) {
-    if (weak.Expired()) {
+    if (!weak.counter_ || !weak.counter_->strong.IncrementIfNotZero()) {
       throw BadWeakPtr{};
     }
     ptr_ = weak.ptr_;
     counter_ = weak.counter_;
-    ++counter_->strong;
   }
   SharedPtr& operator=(const SharedPtr& other) {
     SharedPtr tmp(other);
@@ -58,15 +285,20 @@ class SharedPtr {
     ptr_ = other.ptr_;
     counter_ = other.counter_;
     other.ptr_ = nullptr;
-    other.counter_ = new Counter;
+    other.counter_ = nullptr;
   }
   SharedPtr& operator=(SharedPtr&& other) noexcept {
     SharedPtr tmp(std::move(other));
     Swap(tmp);
     return *this;
   }
-  void Reset(T* ptr = nullptr) {
-    SharedPtr tmp(ptr);
+  void Reset(T* ptr = nullptr, const detail::Site& site = detail::Site::Here()) {
+    SharedPtr tmp(ptr, site);
+    Swap(tmp);
+  }
+  template <typename U, typename Deleter>
+  void Reset(U* ptr, Deleter deleter, const detail::Site& site = detail::Site::Here()) {
+    SharedPtr tmp(ptr, std::move(deleter), site);
     Swap(tmp);
   }
   void Swap(SharedPtr& other) {
@@ -74,7 +306,7 @@ class SharedPtr {
     std::swap(counter_, other.counter_);
   }
   size_t UseCount() const {
-    return (ptr_ ? counter_->strong : 0);
+    return (counter_ ? counter_->strong.Load() : 0);
   }
   T* Get() const {
     return ptr_;
@@ -94,30 +326,34 @@ class SharedPtr {
 
 template <typename T>
 class WeakPtr {
-  friend class SharedPtr<T>;
+  template <typename U>
+  friend class SharedPtr;
+  friend class IntrusivePtr<T>;
   T* ptr_ = nullptr;
-  typename SharedPtr<T>::Counter* counter_ = nullptr;
+  detail::Counter* counter_ = nullptr;
+  WeakPtr(T* ptr, detail::Counter* counter) : ptr_(ptr), counter_(counter) {
+    counter_->weak.Increment();
+  }
 
  public:
-  WeakPtr() : counter_(new typename SharedPtr<T>::Counter) {
-    counter_->strong = 0;
-    counter_->weak = 1;
-  }
+  WeakPtr() = default;
   WeakPtr(const SharedPtr<T>& other) {  // NOLINT
     ptr_ = other.ptr_;
     counter_ = other.counter_;
-    ++counter_->weak;
+    if (counter_) {
+      counter_->weak.Increment();
+    }
   }
   WeakPtr(const WeakPtr& other) {
     ptr_ = other.ptr_;
     counter_ = other.counter_;
-    ++counter_->weak;
+    if (counter_) {
+      counter_->weak.Increment();
+    }
   }
   ~WeakPtr() {
-    if (--counter_->weak == 0) {
-      if (counter_->strong == 0) {
-        delete counter_;
-      }
+    if (counter_ && counter_->weak.Decrement() == 0) {
+      counter_->DestroyCounter();
     }
   }
   WeakPtr& operator=(const WeakPtr& other) {
@@ -129,9 +365,7 @@ class WeakPtr {
     ptr_ = other.ptr_;
     counter_ = other.counter_;
     other.ptr_ = nullptr;
-    other.counter_ = new typename SharedPtr<T>::Counter;
-    other.counter_->strong = 0;
-    other.counter_->weak = 1;
+    other.counter_ = nullptr;
   }
   WeakPtr& operator=(WeakPtr&& other) noexcept {
     WeakPtr tmp(std::move(other));
@@ -147,13 +381,79 @@ class WeakPtr {
     std::swap(counter_, other.counter_);
   }
   size_t UseCount() const {
-    return (ptr_ ? counter_->strong : 0);
+    return (counter_ ? counter_->strong.Load() : 0);
   }
   bool Expired() const {
     return UseCount() == 0;
   }
   SharedPtr<T> Lock() const {
-    return (Expired() ? nullptr : SharedPtr<T>(*this));
+    if (!counter_ || !counter_->strong.IncrementIfNotZero()) {
+      return nullptr;
+    }
+    return SharedPtr<T>(counter_, ptr_);
+  }
+};
+
+#define SHARED_FROM_THIS_IMPLEMENTED
+
+template <typename T>
+class EnableSharedFromThis : public detail::SharedFromThisTag {
+  template <typename U>
+  friend class SharedPtr;
+  mutable WeakPtr<T> weak_this_;
+
+ protected:
+  EnableSharedFromThis() = default;
+  EnableSharedFromThis(const EnableSharedFromThis&) {
+  }
+  EnableSharedFromThis& operator=(const EnableSharedFromThis&) {
+    return *this;
+  }
+  ~EnableSharedFromThis() = default;
+
+ public:
+  using SharedFromThisType = T;
+  SharedPtr<T> SharedFromThis() {
+    return SharedPtr<T>(weak_this_);
+  }
+  SharedPtr<const T> SharedFromThis() const {
+    return SharedPtr<T>(weak_this_);
+  }
+  WeakPtr<T> WeakFromThis() const {
+    return weak_this_;
   }
 };
+
+namespace detail {  // NOLINT
+
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateSharedAt(const Site& site, const Alloc& alloc, Args&&... args) {
+  using Block = detail::InplaceCounter<T, Alloc>;
+  typename Block::CounterAlloc counter_alloc(alloc);
+  Block* block = std::allocator_traits<typename Block::CounterAlloc>::allocate(counter_alloc, 1);
+  try {
+    new (block) Block(alloc, std::forward<Args>(args)...);
+  } catch (...) {
+    std::allocator_traits<typename Block::CounterAlloc>::deallocate(counter_alloc, block, 1);
+    throw;
+  }
+  Track<T>(block, site);
+  SharedPtr<T> result(block, block->Get());
+  result.EnableWeakThis(block->Get());
+  return result;
+}
+
+}  // namespace detail
+
+template <typename T, typename Alloc, typename... Args>
+SHARED_PTR_NOINLINE SharedPtr<T> AllocateShared(const Alloc& alloc, Args&&... args) {
+  return detail::AllocateSharedAt<T>(detail::Site::Caller(__builtin_return_address(0)), alloc,
+                                     std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+SHARED_PTR_NOINLINE SharedPtr<T> MakeShared(Args&&... args) {
+  return detail::AllocateSharedAt<T>(detail::Site::Caller(__builtin_return_address(0)), std::allocator<T>(),
+                                     std::forward<Args>(args)...);
+}
 #endif  // SHAREDPTR
@@ -0,0 +1,285 @@
+#ifndef SHARED_PTR_DEBUG_H
+#define SHARED_PTR_DEBUG_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+
+struct SharedPtrSite {
+  const char* file = nullptr;
+  int line = 0;
+  const void* caller = nullptr;
+};
+
+struct SharedPtrTypeStats {
+  std::string type;
+  size_t live = 0;
+  size_t peak = 0;
+};
+
+struct SharedPtrSurvivor {
+  std::string type;
+  uint64_t sequence = 0;
+  size_t strong = 0;
+  size_t weak = 0;
+  SharedPtrSite site;
+};
+
+struct SharedPtrReport {
+  size_t live = 0;
+  std::vector<SharedPtrTypeStats> types;
+  std::vector<size_t> strong_histogram;
+  std::vector<size_t> weak_histogram;
+  std::vector<SharedPtrSurvivor> oldest;
+};
+
+namespace detail {  // NOLINT
+
+struct Site : SharedPtrSite {
+  static Site Here(const char* file = __builtin_FILE(), int line = __builtin_LINE()) {
+    Site site;
+    site.file = file;
+    site.line = line;
+    return site;
+  }
+  static Site Caller(const void* caller) {
+    Site site;
+    site.caller = caller;
+    return site;
+  }
+};
+
+// slots are handed out from a tagged lock-free free list and published by storing the strong
+// count pointer; Unregister waits for in-flight reports so a report never reads a freed block
+class Registry {
+ public:
+  static constexpr uint32_t kNoSlot = UINT32_MAX;
+  struct TypeStats {
+    const char* type;
+    std::atomic<size_t> live{0};
+    std::atomic<size_t> peak{0};
+    TypeStats* next = nullptr;
+    explicit TypeStats(const char* type) : type(type) {
+    }
+  };
+
+ private:
+  static constexpr size_t kChunkSize = 4096;
+  static constexpr size_t kMaxChunks = 4096;
+  struct Slot {
+    std::atomic<const RefCount*> strong{nullptr};
+    const RefCount* weak = nullptr;
+    TypeStats* stats = nullptr;
+    Site site;
+    uint64_t sequence = 0;
+    std::atomic<uint32_t> next_free{kNoSlot};
+  };
+  std::atomic<Slot*> chunks_[kMaxChunks] = {};
+  std::atomic<uint32_t> high_water_{0};
+  std::atomic<uint64_t> free_head_{kNoSlot};
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<TypeStats*> types_{nullptr};
+  std::atomic<int> readers_{0};
+  Registry() = default;
+  Slot& At(uint32_t index) {
+    return chunks_[index / kChunkSize].load(std::memory_order_acquire)[index % kChunkSize];
+  }
+  static uint64_t Tagged(uint64_t head, uint32_t index) {
+    return (((head >> 32) + 1) << 32) | index;
+  }
+  uint32_t AcquireSlot() {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    while (static_cast<uint32_t>(head) != kNoSlot) {
+      uint32_t index = static_cast<uint32_t>(head);
+      uint32_t next = At(index).next_free.load(std::memory_order_relaxed);
+      if (free_head_.compare_exchange_weak(head, Tagged(head, next), std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+        return index;
+      }
+    }
+    uint32_t index = high_water_.fetch_add(1, std::memory_order_relaxed);
+    size_t chunk = index / kChunkSize;
+    if (chunk >= kMaxChunks) {
+      return kNoSlot;
+    }
+    if (!chunks_[chunk].load(std::memory_order_acquire)) {
+      Slot* fresh = new Slot[kChunkSize];
+      Slot* expected = nullptr;
+      if (!chunks_[chunk].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+        delete[] fresh;
+      }
+    }
+    return index;
+  }
+  void ReleaseSlot(uint32_t index) {
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    do {
+      At(index).next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    } while (!free_head_.compare_exchange_weak(head, Tagged(head, index), std::memory_order_release,
+                                               std::memory_order_relaxed));
+  }
+  TypeStats* AddType(const char* type) {
+    auto stats = new TypeStats(type);
+    stats->next = types_.load(std::memory_order_relaxed);
+    while (!types_.compare_exchange_weak(stats->next, stats, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return stats;
+  }
+  static std::string Demangle(const char* name) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = (status == 0 ? demangled : name);
+    std::free(demangled);
+    return result;
+  }
+  static size_t HistogramBucket(size_t count) {
+    size_t bucket = 0;
+    for (; count > 0; count /= 2) {
+      ++bucket;
+    }
+    return bucket;
+  }
+  static void AddToHistogram(std::vector<size_t>& histogram, size_t count) {
+    size_t bucket = HistogramBucket(count);
+    if (histogram.size() <= bucket) {
+      histogram.resize(bucket + 1);
+    }
+    ++histogram[bucket];
+  }
+
+ public:
+  static Registry& Instance() {
+    static auto registry = new Registry;
+    return *registry;
+  }
+  template <typename T>
+  TypeStats* StatsFor() {
+    static TypeStats* stats = AddType(typeid(T).name());
+    return stats;
+  }
+  uint32_t Register(const RefCount* strong, const RefCount* weak, TypeStats* stats, const Site& site) {
+    uint32_t index = AcquireSlot();
+    if (index == kNoSlot) {
+      return kNoSlot;
+    }
+    Slot& slot = At(index);
+    slot.weak = weak;
+    slot.stats = stats;
+    slot.site = site;
+    slot.sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+    slot.strong.store(strong, std::memory_order_seq_cst);
+    size_t live = stats->live.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t peak = stats->peak.load(std::memory_order_relaxed);
+    while (peak < live && !stats->peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return index;
+  }
+  void Unregister(uint32_t index) {
+    Slot& slot = At(index);
+    slot.stats->live.fetch_sub(1, std::memory_order_relaxed);
+    slot.strong.store(nullptr, std::memory_order_seq_cst);
+    while (readers_.load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+    ReleaseSlot(index);
+  }
+  SharedPtrReport Report(size_t oldest) {
+    SharedPtrReport report;
+    for (TypeStats* stats = types_.load(std::memory_order_acquire); stats; stats = stats->next) {
+      report.types.push_back({Demangle(stats->type), stats->live.load(std::memory_order_relaxed),
+                              stats->peak.load(std::memory_order_relaxed)});
+    }
+    std::sort(report.types.begin(), report.types.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.live > rhs.live; });
+    readers_.fetch_add(1, std::memory_order_seq_cst);
+    size_t end = std::min<size_t>(high_water_.load(std::memory_order_acquire), kChunkSize * kMaxChunks);
+    for (size_t index = 0; index < end; ++index) {
+      Slot* chunk = chunks_[index / kChunkSize].load(std::memory_order_acquire);
+      if (!chunk) {
+        index += kChunkSize - 1 - index % kChunkSize;
+        continue;
+      }
+      Slot& slot = chunk[index % kChunkSize];
+      const RefCount* strong = slot.strong.load(std::memory_order_seq_cst);
+      if (!strong) {
+        continue;
+      }
+      size_t strong_count = strong->Load();
+      size_t weak_count = slot.weak->Load() - (strong_count > 0 ? 1 : 0);
+      ++report.live;
+      AddToHistogram(report.strong_histogram, strong_count);
+      AddToHistogram(report.weak_histogram, weak_count);
+      report.oldest.push_back({slot.stats->type, slot.sequence, strong_count, weak_count, slot.site});
+      if (report.oldest.size() > 2 * oldest + 64) {
+        std::nth_element(report.oldest.begin(), report.oldest.begin() + oldest, report.oldest.end(),
+                         [](const auto& lhs, const auto& rhs) { return lhs.sequence < rhs.sequence; });
+        report.oldest.resize(oldest);
+      }
+    }
+    readers_.fetch_sub(1, std::memory_order_seq_cst);
+    std::sort(report.oldest.begin(), report.oldest.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.sequence < rhs.sequence; });
+    if (report.oldest.size() > oldest) {
+      report.oldest.resize(oldest);
+    }
+    for (auto& survivor : report.oldest) {
+      survivor.type = Demangle(survivor.type.c_str());
+    }
+    return report;
+  }
+};
+
+template <typename T, typename C>
+void Track(C* counter, const Site& site) {
+  Registry& registry = Registry::Instance();
+  counter->debug_slot = registry.Register(&counter->strong, &counter->weak, registry.StatsFor<T>(), site);
+}
+
+inline void Untrack(uint32_t slot) {
+  if (slot != Registry::kNoSlot) {
+    Registry::Instance().Unregister(slot);
+  }
+}
+
+}  // namespace detail
+
+inline SharedPtrReport CollectSharedPtrReport(size_t oldest = 10) {
+  return detail::Registry::Instance().Report(oldest);
+}
+
+inline void DumpSharedPtrReport(std::ostream& out, size_t oldest = 10) {
+  SharedPtrReport report = CollectSharedPtrReport(oldest);
+  out << "live control blocks: " << report.live << '\n';
+  for (const auto& type : report.types) {
+    out << "  " << type.type << ": live " << type.live << ", peak " << type.peak << '\n';
+  }
+  auto histogram = [&out](const char* name, const std::vector<size_t>& buckets) {
+    out << name << " histogram:";
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+      out << ' ' << (bucket == 0 ? 0 : size_t(1) << (bucket - 1)) << "+:" << buckets[bucket];
+    }
+    out << '\n';
+  };
+  histogram("strong", report.strong_histogram);
+  histogram("weak", report.weak_histogram);
+  out << "oldest survivors:\n";
+  for (const auto& survivor : report.oldest) {
+    out << "  #" << survivor.sequence << ' ' << survivor.type << " strong " << survivor.strong << " weak "
+        << survivor.weak << " at ";
+    if (survivor.site.file) {
+      out << survivor.site.file << ':' << survivor.site.line;
+    } else {
+      out << survivor.site.caller;
+    }
+    out << '\n';
+  }
+}
+#endif  // SHARED_PTR_DEBUG_H
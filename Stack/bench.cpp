@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "stack.h"
+#include "chunked_stack.h"
+#include "static_stack.h"
+
+template <typename F>
+double Measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+constexpr size_t kDepth = 4096;
+constexpr int64_t kBranching = 4;
+constexpr int64_t kLevels = 11;
+
+// fills the stack to depth and drains it again, so every round crosses the same chunk boundaries
+template <typename StackT>
+double Sawtooth(StackT& s, size_t rounds, int64_t& sum) {
+  return Measure([&] {
+    for (size_t round = 0; round < rounds; ++round) {
+      for (size_t i = 0; i < kDepth; ++i) {
+        s.Push(static_cast<int64_t>(i + round));
+      }
+      while (!s.Empty()) {
+        sum += s.Top();
+        s.Pop();
+      }
+    }
+  });
+}
+
+// depth-first walk of a complete tree whose nodes are encoded as (index << 8) | level
+template <typename StackT>
+double Traversal(StackT& s, int64_t& sum) {
+  return Measure([&] {
+    s.Push(0);
+    while (!s.Empty()) {
+      int64_t node = s.Top();
+      s.Pop();
+      sum += node >> 8;
+      int64_t level = node & 0xff;
+      if (level < kLevels) {
+        for (int64_t child = 0; child < kBranching; ++child) {
+          s.Push((((node >> 8) * kBranching + child) << 8) | (level + 1));
+        }
+      }
+    }
+  });
+}
+
+template <typename StackT>
+void Bench(const std::string& name, size_t rounds) {
+  StackT s;
+  int64_t sum = 0;
+  Sawtooth(s, 1, sum);
+  double sawtooth_ms = Sawtooth(s, rounds, sum);
+  double traversal_ms = Traversal(s, sum);
+  std::cout << name << ": sawtooth " << sawtooth_ms << " ms, traversal " << traversal_ms << " ms (" << sum << ")\n";
+}
+
+int main() {
+  const size_t rounds = 4096;
+  std::cout << "Push/pop, sawtooth to depth " << kDepth << " x " << rounds << ", traversal of a " << kBranching
+            << "-ary tree with " << kLevels << " levels\n";
+  Bench<Stack<int64_t>>("  std::deque", rounds);
+  Bench<Stack<int64_t, std::vector<int64_t>>>("  std::vector", rounds);
+  Bench<Stack<int64_t, ChunkedStack<int64_t>>>("  ChunkedStack", rounds);
+  Bench<Stack<int64_t, StaticStack<int64_t, kDepth>>>("  StaticStack", rounds);
+}
@@ -0,0 +1,160 @@
+#ifndef CHUNKED_STACK
+#define CHUNKED_STACK
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// LIFO storage in fixed-size chunks that never move, so references stay valid while pushing;
+// chunks emptied by pop_back are kept and refilled by later pushes, and are only released
+// by shrink_to_fit or the destructor. The state is kept in pointers only: a size_t member may
+// alias integer elements, which keeps the compiler from holding values in registers across pushes
+template <typename T, size_t ChunkBytes = 4096>
+class ChunkedStack {
+  static constexpr size_t kChunkSize = std::max<size_t>(1, ChunkBytes / sizeof(T));
+  std::vector<T*> chunks_;
+  T** chunk_ = nullptr;
+  T* begin_ = nullptr;
+  T* top_ = nullptr;
+  T* end_ = nullptr;
+
+  static T* Allocate() {
+    return static_cast<T*>(::operator new(kChunkSize * sizeof(T), std::align_val_t(alignof(T))));
+  }
+  static void Deallocate(T* chunk) {
+    ::operator delete(chunk, std::align_val_t(alignof(T)));
+  }
+  void Enter(T** chunk, T* top) {
+    chunk_ = chunk;
+    begin_ = *chunk;
+    end_ = begin_ + kChunkSize;
+    top_ = top;
+  }
+  // the new element is constructed before the chunk switch is committed, so a throwing
+  // constructor leaves top_ pointing past the last element of the previous chunk
+  template <class... Args>
+  T& EmplaceInNextChunk(Args&&... args) {
+    size_t next = (begin_ ? chunk_ - chunks_.data() + 1 : 0);
+    if (next == chunks_.size()) {
+      T* chunk = Allocate();
+      try {
+        chunks_.push_back(chunk);
+      } catch (...) {
+        Deallocate(chunk);
+        throw;
+      }
+    }
+    T* slot = new (chunks_[next]) T(std::forward<Args>(args)...);
+    Enter(chunks_.data() + next, slot + 1);
+    return *slot;
+  }
+  template <typename F>
+  void ForEach(F&& f) const {
+    if (!begin_) {
+      return;
+    }
+    for (T* const* chunk = chunks_.data(); chunk != chunk_; ++chunk) {
+      std::for_each(*chunk, *chunk + kChunkSize, f);
+    }
+    std::for_each(begin_, top_, f);
+  }
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+
+  ChunkedStack() = default;
+  ChunkedStack(const ChunkedStack& other) : ChunkedStack() {
+    other.ForEach([this](const T& value) { push_back(value); });
+  }
+  ChunkedStack(ChunkedStack&& other) noexcept : ChunkedStack() {
+    swap(other);
+  }
+  template <class InputIt>
+  ChunkedStack(InputIt begin, InputIt end) : ChunkedStack() {
+    for (; begin != end; ++begin) {
+      emplace_back(*begin);
+    }
+  }
+  ChunkedStack& operator=(const ChunkedStack& other) {
+    ChunkedStack tmp(other);
+    swap(tmp);
+    return *this;
+  }
+  ChunkedStack& operator=(ChunkedStack&& other) noexcept {
+    ChunkedStack tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+  ~ChunkedStack() {
+    clear();
+    for (T* chunk : chunks_) {
+      Deallocate(chunk);
+    }
+  }
+  T& back() {
+    return top_[-1];
+  }
+  const T& back() const {
+    return top_[-1];
+  }
+  bool empty() const {
+    return top_ == begin_;
+  }
+  size_t size() const {
+    return (begin_ ? (chunk_ - chunks_.data()) * kChunkSize : 0) + (top_ - begin_);
+  }
+  size_t capacity() const {
+    return chunks_.size() * kChunkSize;
+  }
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (top_ == end_) {
+      return EmplaceInNextChunk(std::forward<Args>(args)...);
+    }
+    T* slot = new (top_) T(std::forward<Args>(args)...);
+    ++top_;
+    return *slot;
+  }
+  void pop_back() {
+    (--top_)->~T();
+    if (top_ == begin_ && chunk_ != chunks_.data()) {
+      Enter(chunk_ - 1, chunk_[-1] + kChunkSize);
+    }
+  }
+  void clear() {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+  // releases the retired chunks above the one in use
+  void shrink_to_fit() {
+    size_t used = (empty() ? 0 : chunk_ - chunks_.data() + 1);
+    for (size_t i = used; i < chunks_.size(); ++i) {
+      Deallocate(chunks_[i]);
+    }
+    chunks_.resize(used);
+    if (used == 0) {
+      chunk_ = nullptr;
+      begin_ = top_ = end_ = nullptr;
+    }
+  }
+  void swap(ChunkedStack& other) noexcept {
+    std::swap(chunks_, other.chunks_);
+    std::swap(chunk_, other.chunk_);
+    std::swap(begin_, other.begin_);
+    std::swap(top_, other.top_);
+    std::swap(end_, other.end_);
+  }
+};
+#endif  // CHUNKED_STACK
@@ -1,61 +1,18 @@
-#ifndef STACK
-#define STACK
-
-#include <deque>
-
-template <typename T, typename Container = std::deque<T> >
-class Stack {
-  Container data_;
- public:
-  Stack() = default;
-  Stack(const Stack& other) = default;
-  Stack(Stack&& other) = default;
-  explicit Stack(const Container& container) {
-    data_ = container;
-  }
-  explicit Stack(Container&& container) {
-    data_ = std::move(container);
-  }
-  template<class InputIt>
-  Stack(InputIt begin, InputIt end) {
-    data_ = Container(begin, end);
-  }
-  Stack& operator=(const Stack& other) = default;
-  Stack& operator=(Stack&&) = default;
-  ~Stack() = default;
-  T& Top() {
-    return data_.back();
-  }
-  const T& Top() const {
-    return data_.back();
-  }
-  bool Empty() const {
-    return data_.empty();
-  }
-  size_t Size() const {
-    return data_.size();
-  }
-  void Push(const T& value) {
-    data_.push_back(value);
-  }
-  template<class... Args>
-  void Emplace( Args&&... args) {
-    data_.emplace_back(args... );
-  }
-  void Pop() {
-    data_.pop_back();
-  }
-  void Swap(Stack& other) noexcept {
-    data_.swap(other.data_);
-  }
-};
-#endif  // STACK
-
 #define CATCH_CONFIG_MAIN
 
+#include <iostream>
 #include <list>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "stack.h"
+#include "stack.h"  // check include guards
+#include "chunked_stack.h"
+#include "chunked_stack.h"  // check include guards
+#include "static_stack.h"
+#include "static_stack.h"  // check include guards
+
 #define REQUIRE(X) if(!(X)) { std::cout << __LINE__ << " error\n"; }
 #define REQUIRE_FALSE(X) if((X)) { std::cout << __LINE__ << " error\n"; }
 #define STR(x) STR2(x)
@@ -184,4 +141,125 @@ TEST_CASE("List", "[Stack]") {
   }
 }
 
+TEST_CASE("Chunked", "[Stack]") {
+  {
+    Stack<std::vector<int>, ChunkedStack<std::vector<int>>> s;
+    REQUIRE(s.Empty());
+    s.Push({1, 2, 3});
+    s.Top()[1] = -2;
+    REQUIRE(s.Top() == (std::vector{1, -2, 3}));
+    s.Emplace(10, 1);
+    REQUIRE(s.Top() == std::vector(10, 1));
+    s.Push(s.Top());
+    REQUIRE(s.Top() == std::vector(10, 1));
+    REQUIRE(s.Size() == 3);
+    s.Pop();
+    s.Pop();
+    REQUIRE(s.Size() == 1);
+    REQUIRE(s.Top() == (std::vector{1, -2, 3}));
+    s.Pop();
+    REQUIRE(s.Empty());
+  }
+
+  {
+    ChunkedStack<std::string, 64> chunks;
+    const size_t per_chunk = 64 / sizeof(std::string);
+    chunks.push_back("0");
+    const std::string* bottom = &chunks.back();
+    for (int i = 1; i < 100; ++i) {
+      chunks.push_back(std::to_string(i));
+    }
+    REQUIRE(&chunks.back() != bottom);
+    const size_t capacity = chunks.capacity();
+    REQUIRE(capacity >= 100u);
+    REQUIRE(capacity < 100u + per_chunk);
+    for (int i = 99; i >= 0; --i) {
+      REQUIRE(chunks.back() == std::to_string(i));
+      chunks.pop_back();
+    }
+    REQUIRE(chunks.empty());
+    REQUIRE(chunks.capacity() == capacity);
+    REQUIRE(&chunks.emplace_back(3, 'a') == bottom);
+    for (int i = 1; i < 100; ++i) {
+      chunks.emplace_back(3, 'a');
+    }
+    REQUIRE(chunks.capacity() == capacity);
+
+    ChunkedStack<std::string, 64> copy(chunks);
+    REQUIRE(copy.size() == 100u);
+    REQUIRE(copy.back() == "aaa");
+    copy.clear();
+    copy.shrink_to_fit();
+    REQUIRE(copy.capacity() == 0u);
+    copy.push_back("x");
+    REQUIRE(copy.back() == "x");
+
+    Stack<std::string, ChunkedStack<std::string, 64>> s(std::move(chunks));
+    REQUIRE(s.Size() == 100u);
+    for (int i = 0; i < 100 - static_cast<int>(per_chunk); ++i) {
+      s.Pop();
+    }
+    REQUIRE(s.Size() == per_chunk);
+    Stack<std::string, ChunkedStack<std::string, 64>> ss;
+    s.Swap(ss);
+    REQUIRE(s.Empty());
+    REQUIRE(ss.Size() == per_chunk);
+    REQUIRE(ss.Top() == "aaa");
+  }
+
+  {
+    std::list<int> d{1, 2, 3};
+    const Stack<int, ChunkedStack<int, 8>> s(d.begin(), d.end());
+    REQUIRE(s.Size() == 3);
+    REQUIRE(s.Top() == 3);
+  }
+}
+
+TEST_CASE("Static", "[Stack]") {
+  {
+    Stack<std::vector<int>, StaticStack<std::vector<int>, 4>> s;
+    REQUIRE(s.Empty());
+    s.Push({1, 2, 3});
+    s.Top()[1] = -2;
+    REQUIRE(s.Top() == (std::vector{1, -2, 3}));
+    s.Emplace(10, 1);
+    REQUIRE(s.Top() == std::vector(10, 1));
+    s.Push(s.Top());
+    REQUIRE(s.Top() == std::vector(10, 1));
+    REQUIRE(s.Size() == 3);
+    s.Push({});
+    REQUIRE_THROWS_AS((s.Push({}), true), StaticStackOverflow);  // NOLINT
+    REQUIRE(s.Size() == 4);
+    s.Pop();
+    s.Pop();
+    s.Pop();
+    REQUIRE(s.Top() == (std::vector{1, -2, 3}));
+  }
+
+  {
+    StaticStack<std::shared_ptr<int>, 8> a;
+    StaticStack<std::shared_ptr<int>, 8> b;
+    auto value = std::make_shared<int>(5);
+    for (int i = 0; i < 5; ++i) {
+      a.push_back(value);
+    }
+    b.push_back(nullptr);
+    REQUIRE(value.use_count() == 6);
+    a.swap(b);
+    REQUIRE(a.size() == 1u);
+    REQUIRE(b.size() == 5u);
+    REQUIRE(value.use_count() == 6);
+    StaticStack<std::shared_ptr<int>, 8> c(b);
+    REQUIRE(value.use_count() == 11);
+    a = std::move(c);
+    REQUIRE(a.size() == 5u);
+    REQUIRE(value.use_count() == 11);
+    c = b;
+    b.clear();
+    REQUIRE(value.use_count() == 11);
+    REQUIRE(*c.back() == 5);
+  }
+  REQUIRE(sizeof(StaticStack<int, 16>) == 16 * sizeof(int) + sizeof(size_t));
+}
+
 }
@@ -1,7 +1,9 @@
 #ifndef STACK
 #define STACK
 
+#include <cstddef>
 #include <deque>
+#include <utility>
 
 template <typename T, typename Container = std::deque<T> >
 class Stack {
@@ -0,0 +1,128 @@
+#ifndef STATIC_STACK
+#define STATIC_STACK
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+class StaticStackOverflow : public std::length_error {
+ public:
+  StaticStackOverflow() : std::length_error("StaticStackOverflow") {
+  }
+};
+
+// LIFO storage for at most N elements kept inline, so it never allocates
+template <typename T, size_t N>
+class StaticStack {
+  static_assert(N > 0);
+  alignas(T) unsigned char buffer_[N * sizeof(T)];
+  T* top_ = Data();
+
+  T* Data() {
+    return std::launder(reinterpret_cast<T*>(buffer_));
+  }
+  const T* Data() const {
+    return std::launder(reinterpret_cast<const T*>(buffer_));
+  }
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+
+  StaticStack() = default;
+  StaticStack(const StaticStack& other) : StaticStack(other.Data(), other.Data() + other.size()) {
+  }
+  StaticStack(StaticStack&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : StaticStack(std::make_move_iterator(other.Data()), std::make_move_iterator(other.top_)) {
+  }
+  template <class InputIt>
+  StaticStack(InputIt begin, InputIt end) {
+    try {
+      for (; begin != end; ++begin) {
+        emplace_back(*begin);
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+  StaticStack& operator=(const StaticStack& other) {
+    if (this != &other) {
+      StaticStack tmp(other);
+      clear();
+      for (T* value = tmp.Data(); value != tmp.top_; ++value) {
+        emplace_back(std::move(*value));
+      }
+    }
+    return *this;
+  }
+  StaticStack& operator=(StaticStack&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (this != &other) {
+      clear();
+      for (T* value = other.Data(); value != other.top_; ++value) {
+        emplace_back(std::move(*value));
+      }
+    }
+    return *this;
+  }
+  ~StaticStack() {
+    clear();
+  }
+  T& back() {
+    return top_[-1];
+  }
+  const T& back() const {
+    return top_[-1];
+  }
+  bool empty() const {
+    return top_ == Data();
+  }
+  size_t size() const {
+    return top_ - Data();
+  }
+  static constexpr size_t capacity() {
+    return N;
+  }
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (top_ == Data() + N) {
+      throw StaticStackOverflow{};
+    }
+    T* slot = new (top_) T(std::forward<Args>(args)...);
+    ++top_;
+    return *slot;
+  }
+  void pop_back() {
+    (--top_)->~T();
+  }
+  void clear() {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+  void swap(StaticStack& other) {
+    StaticStack& shorter = (size() < other.size() ? *this : other);
+    StaticStack& longer = (size() < other.size() ? other : *this);
+    size_t common = shorter.size();
+    std::swap_ranges(shorter.Data(), shorter.top_, longer.Data());
+    while (shorter.size() < longer.size()) {
+      shorter.emplace_back(std::move(longer.Data()[shorter.size()]));
+    }
+    while (longer.size() > common) {
+      longer.pop_back();
+    }
+  }
+};
+#endif  // STATIC_STACK
@@ -1,16 +1,100 @@
+#include <cstdio>
 #include <iostream>
 
 #include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <utility>
 
 #include "unique_ptr.h"
 #include "unique_ptr.h"  // check include guards
+#include "object_pool.h"
+#include "object_pool.h"  // check include guards
 
 #define REQUIRE(X) if(!(X)) { std::cout << __LINE__ << " error\n"; }
 #define REQUIRE_FALSE(X) if((X)) { std::cout << __LINE__ << " error\n"; }
 #define REQUIRE_THROWS_AS(x, e) try { x; throw std::runtime_error("s"); } catch (e ex) {}
 
+struct PoolReturn {
+  std::vector<int*>* pool;
+  void operator()(int* ptr) const {
+    pool->push_back(ptr);
+  }
+};
+
+struct CountingDelete {
+  void operator()(int* ptr) const {
+    ++deleted;
+    delete ptr;
+  }
+  static int deleted;
+};
+
+int CountingDelete::deleted = 0;
+
+struct CloseFile {
+  void operator()(FILE* file) const {
+    std::fclose(file);
+  }
+};
+
+#ifdef DELETER_IMPLEMENTED
+static_assert(sizeof(UniquePtr<int>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<int, CountingDelete>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<FILE, CloseFile>) == sizeof(FILE*));
+static_assert(sizeof(UniquePtr<int, PoolReturn>) == 2 * sizeof(int*));
+static_assert(sizeof(UniquePtr<int, void (*)(int*)>) == 2 * sizeof(int*));
+static_assert(!std::is_default_constructible_v<UniquePtr<int, void (*)(int*)>>);
+static_assert(!std::is_constructible_v<UniquePtr<int, void (*)(int*)>, int*>);
+static_assert(!std::is_constructible_v<UniquePtr<int[], void (*)(int*)>, int*>);
+static_assert(std::is_constructible_v<UniquePtr<int, void (*)(int*)>, int*, void (*)(int*)>);
+static_assert(sizeof(UniquePtr<int[]>) == sizeof(int*));
+#endif
+
+struct Counted {
+  static int alive;
+  int value = 7;
+  Counted() {
+    ++alive;
+  }
+  ~Counted() {
+    --alive;
+  }
+};
+
+int Counted::alive = 0;
+
+struct Node {
+  virtual ~Node() = default;
+  virtual int Evaluate() const = 0;
+};
+
+struct Tag {
+  virtual ~Tag() = default;
+  int tag = 0;
+};
+
+struct Leaf : Tag, Node {
+  static int alive;
+  int value;
+  explicit Leaf(int value) : value(value) {
+    if (value < 0) {
+      throw std::invalid_argument("negative leaf");
+    }
+    ++alive;
+  }
+  ~Leaf() override {
+    --alive;
+  }
+  int Evaluate() const override {
+    return value;
+  }
+};
+
+int Leaf::alive = 0;
+
 int main() {
 
 #define TEST_CASE(a, b) std::cout << a << " " << b << '\n';
@@ -196,4 +280,155 @@ TEST_CASE("MakeUnique", "[UniquePtr]") {
 }
 
 #endif
+
+#ifdef DELETER_IMPLEMENTED
+
+TEST_CASE("Deleter", "[UniquePtr]") {
+  {
+    auto lambda = [](int* ptr) { delete ptr; };
+    static_assert(sizeof(UniquePtr<int, decltype(lambda)>) == sizeof(int*));
+    UniquePtr<int, decltype(lambda)> a(new int(1), lambda);
+    UniquePtr<int, decltype(lambda)> b(nullptr, lambda);
+    b = std::move(a);
+    REQUIRE(!a);
+    REQUIRE(*b == 1);
+  }
+
+  CountingDelete::deleted = 0;
+  {
+    UniquePtr<int, CountingDelete> a(new int(1));
+    UniquePtr<int, CountingDelete> b(std::move(a));
+    REQUIRE(!a);
+    b.Reset(new int(2));
+    REQUIRE(CountingDelete::deleted == 1);
+    b.Reset();
+    REQUIRE(CountingDelete::deleted == 2);
+    b.Reset(new int(3));
+  }
+  REQUIRE(CountingDelete::deleted == 3);
+
+  std::vector<int*> first_pool;
+  std::vector<int*> second_pool;
+  {
+    UniquePtr<int, PoolReturn> a(new int(1), PoolReturn{&first_pool});
+    UniquePtr<int, PoolReturn> b(new int(2), PoolReturn{&second_pool});
+    a.Swap(b);
+    REQUIRE(a.GetDeleter().pool == &second_pool);
+    UniquePtr<int, PoolReturn> c(nullptr, PoolReturn{&first_pool});
+    c = std::move(a);
+    REQUIRE(c.GetDeleter().pool == &second_pool);
+  }
+  REQUIRE(first_pool.size() == 1u);
+  REQUIRE(second_pool.size() == 1u);
+  REQUIRE(*first_pool[0] == 1);
+  REQUIRE(*second_pool[0] == 2);
+  delete first_pool[0];
+  delete second_pool[0];
+
+  {
+    UniquePtr<FILE, CloseFile> file(std::tmpfile());
+    REQUIRE(file);
+    REQUIRE(std::fputs("data", file.Get()) >= 0);
+    UniquePtr<FILE, CloseFile> empty;
+    REQUIRE(!empty);
+  }
+
+  {
+    UniquePtr<int, void (*)(int*)> a(new int(5), [](int* ptr) { delete ptr; });
+    REQUIRE(*a == 5);
+  }
+}
+
+#endif
+
+#ifdef MAKE_UNIQUE_IMPLEMENTED
+
+TEST_CASE("Array", "[UniquePtr]") {
+  {
+    UniquePtr<Counted[]> a(new Counted[5]);
+    REQUIRE(Counted::alive == 5);
+    a[2].value = 3;
+    REQUIRE(a[2].value == 3);
+    REQUIRE(a[1].value == 7);
+    UniquePtr<Counted[]> b(std::move(a));
+    REQUIRE(!a);
+    b.Reset(new Counted[2]);
+    REQUIRE(Counted::alive == 2);
+    a.Swap(b);
+    REQUIRE(a[0].value == 7);
+  }
+  REQUIRE(Counted::alive == 0);
+
+  {
+    auto zeroed = MakeUnique<int[]>(1000);
+    bool all_zero = true;
+    for (size_t i = 0; i < 1000; ++i) {
+      all_zero = all_zero && zeroed[i] == 0;
+    }
+    REQUIRE(all_zero);
+    auto scratch = MakeUniqueForOverwrite<int[]>(1 << 20);
+    for (size_t i = 0; i < (1 << 20); ++i) {
+      scratch[i] = static_cast<int>(i);
+    }
+    REQUIRE(scratch[12345] == 12345);
+    auto objects = MakeUniqueForOverwrite<Counted[]>(4);
+    REQUIRE(Counted::alive == 4);
+    REQUIRE(objects[3].value == 7);
+    auto single = MakeUniqueForOverwrite<Counted>();
+    REQUIRE(single->value == 7);
+  }
+  REQUIRE(Counted::alive == 0);
+}
+
+#endif
+
+TEST_CASE("ObjectPool", "[UniquePtr]") {
+  static_assert(sizeof(ObjectPool<Leaf>::Handle) == sizeof(Leaf*));
+  ObjectPool<Leaf> pool;
+  {
+    auto a = pool.Make(1);
+    auto b = pool.Make(2);
+    REQUIRE(a->value + b->value == 3);
+    REQUIRE(reinterpret_cast<uintptr_t>(a.Get()) % alignof(Leaf) == 0);
+    Leaf* first = a.Get();
+    a.Reset();
+    REQUIRE(Leaf::alive == 1);
+    auto c = pool.Make(3);
+    REQUIRE(c.Get() == first);
+    UniquePtr<Node, PoolDeleter> node = pool.Make(4);
+    REQUIRE(static_cast<void*>(node.Get()) != static_cast<void*>(c.Get()));
+    REQUIRE(node->Evaluate() == 4);
+    REQUIRE_THROWS_AS(pool.Make(-1), std::invalid_argument&);
+    REQUIRE(pool.Make(5)->value == 5);
+  }
+  REQUIRE(Leaf::alive == 0);
+
+  {
+    std::vector<ObjectPool<Leaf>::Handle> handles;
+    std::set<Leaf*> addresses;
+    size_t count = 3 * ObjectPool<Leaf>::SlotsPerChunk();
+    for (size_t i = 0; i < count; ++i) {
+      handles.push_back(pool.Make(static_cast<int>(i)));
+      addresses.insert(handles.back().Get());
+    }
+    REQUIRE(addresses.size() == count);
+    size_t chunks = pool.ChunkCount();
+    REQUIRE(chunks >= 3u);
+    std::thread([&handles] { handles.clear(); }).join();
+    REQUIRE(Leaf::alive == 0);
+    for (size_t i = 0; i < count; ++i) {
+      handles.push_back(pool.Make(static_cast<int>(i)));
+      REQUIRE(addresses.count(handles.back().Get()) == 1u);
+    }
+    REQUIRE(pool.ChunkCount() == chunks);
+  }
+  REQUIRE(Leaf::alive == 0);
+
+  {
+    UniquePtr<Leaf> derived(new Leaf(6));
+    UniquePtr<Node> moved = std::move(derived);
+    REQUIRE(moved->Evaluate() == 6);
+  }
+  REQUIRE(Leaf::alive == 0);
+}
 }
@@ -0,0 +1,134 @@
+#ifndef OBJECT_POOL
+#define OBJECT_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail {  // NOLINT
+
+// chunks are aligned to their size, so any object pointer leads back to its chunk header
+// and PoolDeleter needs no state
+struct PoolChunk {
+  static constexpr size_t kBytes = size_t(1) << 16;
+  static constexpr size_t kCacheLine = 64;
+  void* pool;
+  void (*release)(void* pool, void* object);
+  PoolChunk* next;
+  static PoolChunk* Of(const void* object) {
+    return reinterpret_cast<PoolChunk*>(reinterpret_cast<uintptr_t>(object) & ~(kBytes - 1));
+  }
+};
+
+}  // namespace detail
+
+struct PoolDeleter {
+  template <typename T>
+  void operator()(T* ptr) const {
+    detail::PoolChunk* chunk = detail::PoolChunk::Of(ptr);
+    ptr->~T();
+    chunk->release(chunk->pool, const_cast<std::remove_cv_t<T>*>(ptr));
+  }
+};
+
+// Make must be called on the thread that created the pool; handles may be destroyed on any
+// thread, foreign threads return slots through an atomic list the owner adopts when it runs dry
+template <typename T>
+class ObjectPool {
+  using Chunk = detail::PoolChunk;
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+  static constexpr size_t kSlotAlignment = std::max(alignof(T), alignof(FreeSlot));
+  static constexpr size_t kSlotSize =
+      (std::max(sizeof(T), sizeof(FreeSlot)) + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+  static constexpr size_t kFirstSlotAlignment = std::max(kSlotAlignment, Chunk::kCacheLine);
+  static constexpr size_t kFirstSlot =
+      (sizeof(Chunk) + kFirstSlotAlignment - 1) / kFirstSlotAlignment * kFirstSlotAlignment;
+  static constexpr size_t kSlotsPerChunk = (Chunk::kBytes - kFirstSlot) / kSlotSize;
+  static_assert(kFirstSlot < Chunk::kBytes && kSlotsPerChunk >= 8, "ObjectPool slots must fit a 64 KiB chunk");
+  std::thread::id owner_ = std::this_thread::get_id();
+  Chunk* chunks_ = nullptr;
+  size_t chunk_count_ = 0;
+  FreeSlot* free_ = nullptr;
+  std::atomic<FreeSlot*> remote_free_{nullptr};
+  char* bump_ = nullptr;
+  char* bump_end_ = nullptr;
+  void NewChunk() {
+    void* memory = ::operator new(Chunk::kBytes, std::align_val_t(Chunk::kBytes));
+    chunks_ = new (memory) Chunk{this, &Release, chunks_};
+    ++chunk_count_;
+    bump_ = static_cast<char*>(memory) + kFirstSlot;
+    bump_end_ = bump_ + kSlotsPerChunk * kSlotSize;
+  }
+  void* Allocate() {
+    if (!free_ && remote_free_.load(std::memory_order_relaxed)) {
+      free_ = remote_free_.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (free_) {
+      FreeSlot* slot = free_;
+      free_ = slot->next;
+      return slot;
+    }
+    if (bump_ == bump_end_) {
+      NewChunk();
+    }
+    void* slot = bump_;
+    bump_ += kSlotSize;
+    return slot;
+  }
+  void Free(void* object) {
+    char* first = reinterpret_cast<char*>(Chunk::Of(object)) + kFirstSlot;
+    char* slot = first + (static_cast<char*>(object) - first) / kSlotSize * kSlotSize;
+    auto free_slot = new (slot) FreeSlot{nullptr};
+    if (std::this_thread::get_id() == owner_) {
+      free_slot->next = free_;
+      free_ = free_slot;
+      return;
+    }
+    free_slot->next = remote_free_.load(std::memory_order_relaxed);
+    while (!remote_free_.compare_exchange_weak(free_slot->next, free_slot, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+  }
+  static void Release(void* pool, void* object) {
+    static_cast<ObjectPool*>(pool)->Free(object);
+  }
+
+ public:
+  using Handle = UniquePtr<T, PoolDeleter>;
+  ObjectPool() = default;
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+  ~ObjectPool() {
+    while (chunks_) {
+      Chunk* next = chunks_->next;
+      ::operator delete(chunks_, std::align_val_t(Chunk::kBytes));
+      chunks_ = next;
+    }
+  }
+  template <typename... Args>
+  Handle Make(Args&&... args) {
+    void* slot = Allocate();
+    try {
+      return Handle(new (slot) T(std::forward<Args>(args)...));
+    } catch (...) {
+      Free(slot);
+      throw;
+    }
+  }
+  size_t ChunkCount() const {
+    return chunk_count_;
+  }
+  static constexpr size_t SlotsPerChunk() {
+    return kSlotsPerChunk;
+  }
+};
+#endif  // OBJECT_POOL
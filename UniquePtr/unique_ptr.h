@@ -1,22 +1,79 @@
 #ifndef UNIQUEPTR
 #define UNIQUEPTR
+#define DELETER_IMPLEMENTED
+#define MAKE_UNIQUE_IMPLEMENTED
 
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
-template <typename T>
-class UniquePtr {
+namespace detail {  // NOLINT
+
+template <typename Deleter, bool = std::is_empty_v<Deleter> && !std::is_final_v<Deleter>>
+class DeleterHolder : private Deleter {
+ public:
+  DeleterHolder() = default;
+  explicit DeleterHolder(Deleter&& deleter) : Deleter(std::move(deleter)) {
+  }
+  Deleter& GetDeleter() {
+    return *this;
+  }
+  const Deleter& GetDeleter() const {
+    return *this;
+  }
+};
+
+template <typename Deleter>
+class DeleterHolder<Deleter, false> {
+  Deleter deleter_{};
+
+ public:
+  DeleterHolder() = default;
+  explicit DeleterHolder(Deleter&& deleter) : deleter_(std::forward<Deleter>(deleter)) {
+  }
+  Deleter& GetDeleter() {
+    return deleter_;
+  }
+  const Deleter& GetDeleter() const {
+    return deleter_;
+  }
+};
+
+// a value-initialized function pointer deleter would be null, so it has to be passed explicitly
+template <typename Deleter>
+using EnableIfDefaultDeleter = std::enable_if_t<!std::is_pointer_v<Deleter>>;
+
+}  // namespace detail
+
+template <typename T, typename Deleter = std::default_delete<T>>
+class UniquePtr : private detail::DeleterHolder<Deleter> {
+  using Holder = detail::DeleterHolder<Deleter>;
   T* ptr_ = nullptr;
 
  public:
-  UniquePtr() = default;
+  template <typename D = Deleter, typename = detail::EnableIfDefaultDeleter<D>>
+  UniquePtr() {
+  }
+  template <typename D = Deleter, typename = detail::EnableIfDefaultDeleter<D>>
   explicit UniquePtr(T* ptr) : ptr_(ptr) {
   }
+  UniquePtr(T* ptr, Deleter deleter) : Holder(std::forward<Deleter>(deleter)), ptr_(ptr) {
+  }
   UniquePtr(const UniquePtr&) = delete;
   ~UniquePtr() {
-    delete ptr_;
+    if (ptr_) {
+      GetDeleter()(ptr_);
+    }
   }
   UniquePtr& operator=(const UniquePtr&) = delete;
-  UniquePtr(UniquePtr&& other) noexcept {
+  UniquePtr(UniquePtr&& other) noexcept : Holder(std::forward<Deleter>(other.GetDeleter())) {
+    ptr_ = other.Release();
+  }
+  template <typename U, typename E,
+            typename = std::enable_if_t<!std::is_array_v<U> && std::is_convertible_v<U*, T*> &&
+                                        std::is_convertible_v<E, Deleter>>>
+  UniquePtr(UniquePtr<U, E>&& other) noexcept : Holder(Deleter(std::forward<E>(other.GetDeleter()))) {  // NOLINT
     ptr_ = other.Release();
   }
   UniquePtr& operator=(UniquePtr&& other) noexcept {
@@ -30,16 +87,28 @@ class UniquePtr {
     return ptr;
   }
   void Reset(T* ptr = nullptr) {
-    delete ptr_;
+    T* old = ptr_;
     ptr_ = ptr;
+    if (old) {
+      GetDeleter()(old);
+    }
   }
   void Swap(UniquePtr& other) {
     std::swap(ptr_, other.ptr_);
+    if constexpr (!std::is_empty_v<Deleter>) {
+      std::swap(GetDeleter(), other.GetDeleter());
+    }
   }
   T* Get() const {
     return ptr_;
   }
-  T& operator*() const {
+  Deleter& GetDeleter() {
+    return Holder::GetDeleter();
+  }
+  const Deleter& GetDeleter() const {
+    return Holder::GetDeleter();
+  }
+  std::add_lvalue_reference_t<T> operator*() const {
     return *ptr_;
   }
   T* operator->() const {
@@ -49,4 +118,94 @@ class UniquePtr {
     return ptr_ != nullptr;
   }
 };
+
+template <typename T, typename Deleter>
+class UniquePtr<T[], Deleter> : private detail::DeleterHolder<Deleter> {
+  using Holder = detail::DeleterHolder<Deleter>;
+  T* ptr_ = nullptr;
+
+ public:
+  template <typename D = Deleter, typename = detail::EnableIfDefaultDeleter<D>>
+  UniquePtr() {
+  }
+  template <typename D = Deleter, typename = detail::EnableIfDefaultDeleter<D>>
+  explicit UniquePtr(T* ptr) : ptr_(ptr) {
+  }
+  UniquePtr(T* ptr, Deleter deleter) : Holder(std::forward<Deleter>(deleter)), ptr_(ptr) {
+  }
+  UniquePtr(const UniquePtr&) = delete;
+  ~UniquePtr() {
+    if (ptr_) {
+      GetDeleter()(ptr_);
+    }
+  }
+  UniquePtr& operator=(const UniquePtr&) = delete;
+  UniquePtr(UniquePtr&& other) noexcept : Holder(std::forward<Deleter>(other.GetDeleter())) {
+    ptr_ = other.Release();
+  }
+  UniquePtr& operator=(UniquePtr&& other) noexcept {
+    UniquePtr tmp(std::move(other));
+    Swap(tmp);
+    return *this;
+  }
+  T* Release() {
+    T* ptr = ptr_;
+    ptr_ = nullptr;
+    return ptr;
+  }
+  void Reset(T* ptr = nullptr) {
+    T* old = ptr_;
+    ptr_ = ptr;
+    if (old) {
+      GetDeleter()(old);
+    }
+  }
+  void Swap(UniquePtr& other) {
+    std::swap(ptr_, other.ptr_);
+    if constexpr (!std::is_empty_v<Deleter>) {
+      std::swap(GetDeleter(), other.GetDeleter());
+    }
+  }
+  T* Get() const {
+    return ptr_;
+  }
+  Deleter& GetDeleter() {
+    return Holder::GetDeleter();
+  }
+  const Deleter& GetDeleter() const {
+    return Holder::GetDeleter();
+  }
+  T& operator[](size_t index) const {
+    return ptr_[index];
+  }
+  explicit operator bool() const {
+    return ptr_ != nullptr;
+  }
+};
+
+template <typename T, typename... Args>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> MakeUnique(Args&&... args) {
+  return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+template <typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, UniquePtr<T>> MakeUnique(size_t size) {
+  return UniquePtr<T>(new std::remove_extent_t<T>[size]());
+}
+
+template <typename T, typename... Args>
+std::enable_if_t<std::extent_v<T> != 0> MakeUnique(Args&&...) = delete;
+
+template <typename T>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> MakeUniqueForOverwrite() {
+  return UniquePtr<T>(new T);
+}
+
+template <typename T>
+std::enable_if_t<std::is_array_v<T> && std::extent_v<T> == 0, UniquePtr<T>> MakeUniqueForOverwrite(size_t size) {
+  return UniquePtr<T>(new std::remove_extent_t<T>[size]);
+}
+
+template <typename T, typename... Args>
+std::enable_if_t<std::extent_v<T> != 0> MakeUniqueForOverwrite(Args&&...) = delete;
 #endif  // UNIQUEPTR
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unordered_set.h"
+#include "concurrent_unordered_set.h"
+#include "unordered_map.h"
+#include "frozen_unordered_set.h"
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+template <typename F>
+double Measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+template <typename Policy>
+void BenchPolicy(const std::string& name, const std::vector<uint64_t>& keys) {
+  UnorderedSet<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, Policy> us;
+  double insert_ms = Measure([&] {
+    for (auto key : keys) {
+      us.Insert(key);
+    }
+  });
+  size_t found = 0;
+  double find_ms = Measure([&] {
+    for (auto key : keys) {
+      found += us.Find(key);
+      found += us.Find(key + 1);
+    }
+  });
+  auto stats = us.Stats();
+  std::cout << name << ": insert " << insert_ms << " ms, find " << find_ms << " ms, max bucket "
+            << stats.max_chain_length << ", average probe " << stats.average_probe_length << " (" << found << ")\n";
+}
+
+void BenchInsertLatency(const std::string& name, size_t rehash_step, size_t n) {
+  UnorderedSet<uint64_t> us;
+  us.SetRehashStep(rehash_step);
+  std::vector<double> latencies(n);
+  for (size_t i = 0; i < n; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    us.Insert(i * 0x9E3779B97F4A7C15ull);
+    auto finish = std::chrono::steady_clock::now();
+    latencies[i] = std::chrono::duration<double, std::micro>(finish - start).count();
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (n - 1))]; };
+  std::cout << name << ": p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, p999 "
+            << percentile(0.999) << " us, max " << latencies.back() << " us\n";
+}
+
+void BenchBatch(size_t n) {
+  std::vector<uint64_t> keys(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = i * 0x9E3779B97F4A7C15ull;
+  }
+  UnorderedSet<uint64_t> us;
+  double build_ms = Measure([&] { us.InsertRange(keys.begin(), keys.end()); });
+  std::vector<uint64_t> probes(n);
+  for (size_t i = 0; i < n; ++i) {
+    probes[i] = keys[(i * 7919) % n] + (i % 2);
+  }
+  size_t found = 0;
+  double single_ms = Measure([&] {
+    for (auto key : probes) {
+      found += us.Find(key);
+    }
+  });
+  std::vector<uint64_t> bitmap((n + 63) / 64);
+  double batch_ms = Measure([&] { us.FindBatch(probes.data(), probes.size(), bitmap.data()); });
+  size_t batch_found = 0;
+  for (auto word : bitmap) {
+    batch_found += __builtin_popcountll(word);
+  }
+  uint64_t sum = 0;
+  double scan_ms = Measure([&] {
+    for (auto key : us) {
+      sum += key;
+    }
+  });
+  std::cout << "Bulk, " << n << " keys: InsertRange " << build_ms << " ms, Find loop " << single_ms
+            << " ms, FindBatch " << batch_ms << " ms, full scan " << scan_ms << " ms (" << found << '/' << batch_found << '/'
+            << sum % 2 << ")\n";
+}
+
+void BenchMapChurn(size_t n) {
+  UnorderedMap<uint64_t, uint64_t> um;
+  for (size_t i = 0; i < n; ++i) {
+    um.TryEmplace(i, i);
+  }
+  size_t before = allocations;
+  double ms = Measure([&] {
+    for (size_t i = 0; i < n; ++i) {
+      auto node = um.Extract(i);
+      node.Key() += n;
+      um.Insert(std::move(node));
+      um.Erase(i + n);
+      um[i] = i;
+    }
+  });
+  std::cout << "UnorderedMap churn, " << n << " keys: " << ms << " ms, " << allocations - before
+            << " allocations\n";
+}
+
+void BenchStringMapChurn(size_t n) {
+  std::vector<std::string> keys(2 * n);
+  for (size_t i = 0; i < 2 * n; ++i) {
+    keys[i] = std::to_string(i);
+    keys[i].resize(32, 'k');
+  }
+  UnorderedMap<std::string, uint64_t> um;
+  for (size_t i = 0; i < 2 * n; ++i) {
+    um.TryEmplace(keys[i], i);
+  }
+  size_t before = allocations;
+  double ms = Measure([&] {
+    for (size_t i = 0; i < n; ++i) {
+      um.Insert(um.Extract(keys[i]));
+      um.Erase(keys[n + i]);
+    }
+  });
+  std::cout << "UnorderedMap<std::string> churn, " << n << " keys: " << ms << " ms, " << allocations - before
+            << " allocations\n";
+}
+
+void BenchFilter(size_t n) {
+  UnorderedSet<uint64_t> plain;
+  for (size_t i = 0; i < n; ++i) {
+    plain.Insert(i * 0x9E3779B97F4A7C15ull);
+  }
+  UnorderedSet<uint64_t> filtered = plain;
+  filtered.AttachFilter(n);
+  for (size_t hit_percent : {1, 10, 50}) {
+    std::vector<uint64_t> probes(n);
+    for (size_t i = 0; i < n; ++i) {
+      size_t j = (i * 7919) % n;
+      probes[i] = (i % 100 < hit_percent ? j : j + n) * 0x9E3779B97F4A7C15ull;
+    }
+    size_t found = 0;
+    double plain_ms = Measure([&] {
+      for (auto key : probes) {
+        found += plain.Find(key);
+      }
+    });
+    double filtered_ms = Measure([&] {
+      for (auto key : probes) {
+        found += filtered.Find(key);
+      }
+    });
+    std::cout << "Filter, " << hit_percent << "% hits: plain " << n / plain_ms / 1000 << " Mops/s, bloom "
+              << n / filtered_ms / 1000 << " Mops/s (" << found << ")\n";
+  }
+}
+
+void BenchFrozen(size_t n) {
+  const std::string path = "frozen_unordered_set_bench.bin";
+  std::vector<uint64_t> keys(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = i * 0x9E3779B97F4A7C15ull;
+  }
+  UnorderedSet<uint64_t> us;
+  double build_ms = Measure([&] { us.InsertRange(keys.begin(), keys.end()); });
+  double write_ms = Measure([&] { FrozenUnorderedSet<uint64_t>::Write(us, path); });
+  size_t found = 0;
+  double open_ms = 0;
+  double find_ms = 0;
+  {
+    std::optional<FrozenUnorderedSet<uint64_t> > frozen;
+    open_ms = Measure([&] { frozen.emplace(FrozenUnorderedSet<uint64_t>::Open(path)); });
+    find_ms = Measure([&] {
+      for (auto key : keys) {
+        found += frozen->Find(key);
+      }
+    });
+  }
+  std::remove(path.c_str());
+  std::cout << "Frozen, " << n << " keys: build " << build_ms << " ms, write " << write_ms << " ms, open "
+            << open_ms << " ms, find all " << find_ms << " ms (" << found << ")\n";
+}
+
+class GlobalMutexSet {
+  std::mutex mutex_;
+  UnorderedSet<uint64_t> set_;
+
+ public:
+  void Insert(uint64_t key) {
+    std::lock_guard lock(mutex_);
+    if (!set_.Find(key)) {
+      set_.Insert(key);
+    }
+  }
+  bool Find(uint64_t key) {
+    std::lock_guard lock(mutex_);
+    return set_.Find(key);
+  }
+};
+
+template <typename Set>
+double BenchMixed(Set& set, size_t threads, size_t read_percent, size_t ops_per_thread) {
+  std::vector<std::thread> workers;
+  double ms = Measure([&] {
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&set, t, read_percent, ops_per_thread] {
+        uint64_t state = t * 0x9E3779B97F4A7C15ull + 1;
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+          state ^= state << 13;
+          state ^= state >> 7;
+          state ^= state << 17;
+          uint64_t key = state % (1 << 20);
+          if (state % 100 < read_percent) {
+            set.Find(key);
+          } else {
+            set.Insert(key);
+          }
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  });
+  return threads * ops_per_thread / ms / 1000;
+}
+
+void BenchConcurrent(size_t read_percent) {
+  const size_t ops_per_thread = 1 << 18;
+  const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "Concurrent, " << read_percent << "% reads (Mops/s)\n";
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    GlobalMutexSet global;
+    ConcurrentUnorderedSet<uint64_t> sharded;
+    std::cout << "  " << threads << " threads: global mutex " << BenchMixed(global, threads, read_percent, ops_per_thread)
+              << ", sharded " << BenchMixed(sharded, threads, read_percent, ops_per_thread) << '\n';
+  }
+}
+
+int main() {
+  const size_t n = 1 << 20;
+  std::vector<uint64_t> sequential(n);
+  std::vector<uint64_t> strided(n / 16);
+  for (size_t i = 0; i < n; ++i) {
+    sequential[i] = i;
+  }
+  for (size_t i = 0; i < n / 16; ++i) {
+    strided[i] = i << 12;
+  }
+
+  std::cout << "BucketPolicy, sequential keys\n";
+  BenchPolicy<ModuloBucketPolicy>("  modulo", sequential);
+  BenchPolicy<PowerOfTwoBucketPolicy>("  power of two", sequential);
+  BenchPolicy<FastModBucketPolicy>("  fastmod", sequential);
+
+  std::cout << "BucketPolicy, strided keys\n";
+  BenchPolicy<ModuloBucketPolicy>("  modulo", strided);
+  BenchPolicy<PowerOfTwoBucketPolicy>("  power of two", strided);
+  BenchPolicy<FastModBucketPolicy>("  fastmod", strided);
+
+  std::cout << "Insert latency\n";
+  BenchInsertLatency("  stop-the-world rehash", 0, n * 4);
+  BenchInsertLatency("  incremental rehash, 4 buckets per operation", 4, n * 4);
+
+  BenchConcurrent(50);
+  BenchConcurrent(90);
+  BenchConcurrent(99);
+
+  BenchBatch(n * 4);
+
+  BenchMapChurn(n);
+  BenchStringMapChurn(n);
+
+  BenchFilter(n * 4);
+
+  BenchFrozen(n * 4);
+}
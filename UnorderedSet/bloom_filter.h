@@ -0,0 +1,72 @@
+#ifndef BLOOM_FILTER
+#define BLOOM_FILTER
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BlockedBloomFilter {
+  static constexpr size_t kBlockBits = 512;
+  static constexpr size_t kWords = kBlockBits / 64;
+  struct alignas(64) Block {
+    uint64_t words[kWords] = {};
+  };
+  std::vector<Block> blocks_;
+  static uint64_t Mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+  size_t BlockIndex(uint64_t mixed) const {
+    return static_cast<size_t>(((mixed >> 32) * blocks_.size()) >> 32);
+  }
+  static uint64_t Bit(uint64_t mixed, size_t word) {
+    static constexpr uint32_t kSalt[kWords] = {0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+                                               0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u};
+    return uint64_t(1) << ((static_cast<uint32_t>(mixed) * kSalt[word]) >> 26);
+  }
+
+ public:
+  BlockedBloomFilter() = default;
+  explicit BlockedBloomFilter(size_t expected_keys, size_t bits_per_key = 10)
+      : blocks_(std::max<size_t>(1, (expected_keys * bits_per_key + kBlockBits - 1) / kBlockBits)) {
+  }
+  void Add(size_t hash) {
+    if (blocks_.empty()) {
+      return;
+    }
+    uint64_t mixed = Mix(hash);
+    Block& block = blocks_[BlockIndex(mixed)];
+    for (size_t i = 0; i < kWords; ++i) {
+      block.words[i] |= Bit(mixed, i);
+    }
+  }
+  bool MayContain(size_t hash) const {
+    if (blocks_.empty()) {
+      return true;
+    }
+    uint64_t mixed = Mix(hash);
+    const Block& block = blocks_[BlockIndex(mixed)];
+    uint64_t missing = 0;
+    for (size_t i = 0; i < kWords; ++i) {
+      missing |= Bit(mixed, i) & ~block.words[i];
+    }
+    return missing == 0;
+  }
+  void Clear() {
+    for (auto& block : blocks_) {
+      block = Block{};
+    }
+  }
+  size_t BlockCount() const {
+    return blocks_.size();
+  }
+  size_t MemoryUsage() const {
+    return blocks_.size() * sizeof(Block);
+  }
+};
+#endif  // BLOOM_FILTER
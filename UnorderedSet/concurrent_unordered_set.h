@@ -0,0 +1,145 @@
+#ifndef CONCURRENT_UNORDERED_SET
+#define CONCURRENT_UNORDERED_SET
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "unordered_set.h"
+
+template <typename KeyT, typename Hash = std::hash<KeyT>, typename KeyEqual = std::equal_to<KeyT>,
+          typename BucketPolicy = ModuloBucketPolicy>
+class ConcurrentUnorderedSet {
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    UnorderedSet<KeyT, Hash, KeyEqual, BucketPolicy> set;
+    std::atomic<size_t> size{0};
+  };
+  Hash hasher_;
+  std::unique_ptr<Shard[]> shards_;
+  size_t shard_count_ = 0;
+  unsigned shard_shift_ = 64;
+  // the shard comes from a separately mixed copy of the hash, so it stays independent of
+  // the bits each shard's BucketPolicy uses (Fibonacci hashing takes the top of hash * phi)
+  Shard& ShardFor(size_t hash) const {
+    if (shard_count_ == 1) {
+      return shards_[0];
+    }
+    uint64_t mixed = static_cast<uint64_t>(hash);
+    mixed = (mixed ^ (mixed >> 33)) * 0xFF51AFD7ED558CCDull;
+    mixed = (mixed ^ (mixed >> 33)) * 0xC4CEB9FE1A85EC53ull;
+    return shards_[(mixed ^ (mixed >> 33)) >> shard_shift_];
+  }
+
+ public:
+  explicit ConcurrentUnorderedSet(size_t shard_count = 64) {
+    shard_count_ = 1;
+    while (shard_count_ < shard_count) {
+      shard_count_ *= 2;
+      --shard_shift_;
+    }
+    shards_ = std::make_unique<Shard[]>(shard_count_);
+  }
+  ConcurrentUnorderedSet(const ConcurrentUnorderedSet&) = delete;
+  ConcurrentUnorderedSet& operator=(const ConcurrentUnorderedSet&) = delete;
+  ~ConcurrentUnorderedSet() = default;
+  size_t Size() const {
+    size_t size = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      size += shards_[i].size.load(std::memory_order_relaxed);
+    }
+    return size;
+  }
+  bool Empty() const {
+    return Size() == 0;
+  }
+  size_t ShardCount() const {
+    return shard_count_;
+  }
+  void Clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::unique_lock lock(shards_[i].mutex);
+      shards_[i].set.Clear();
+      shards_[i].size.store(0, std::memory_order_relaxed);
+    }
+  }
+  bool Insert(const KeyT& key) {
+    size_t h = hasher_(key);
+    Shard& shard = ShardFor(h);
+    std::unique_lock lock(shard.mutex);
+    if (shard.set.Find(key, h)) {
+      return false;
+    }
+    shard.set.Insert(key, h);
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  bool Insert(KeyT&& key) {
+    size_t h = hasher_(key);
+    Shard& shard = ShardFor(h);
+    std::unique_lock lock(shard.mutex);
+    if (shard.set.Find(key, h)) {
+      return false;
+    }
+    shard.set.Insert(std::move(key), h);
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  bool Erase(const KeyT& key) {
+    size_t h = hasher_(key);
+    Shard& shard = ShardFor(h);
+    std::unique_lock lock(shard.mutex);
+    if (!shard.set.Find(key, h)) {
+      return false;
+    }
+    shard.set.Erase(key, h);
+    shard.size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  bool Find(const KeyT& key) const {
+    size_t h = hasher_(key);
+    const Shard& shard = ShardFor(h);
+    std::shared_lock lock(shard.mutex);
+    return shard.set.Find(key, h);
+  }
+  bool Contains(const KeyT& key) const {
+    return Find(key);
+  }
+  HashTableStats Stats() const {
+    HashTableStats stats;
+    double probes = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+      std::shared_lock lock(shards_[i].mutex);
+      HashTableStats shard = shards_[i].set.Stats();
+      stats.size += shard.size;
+      stats.bucket_count += shard.bucket_count;
+      stats.bytes_allocated += shard.bytes_allocated;
+      stats.max_chain_length = std::max(stats.max_chain_length, shard.max_chain_length);
+      if (stats.bucket_size_histogram.size() < shard.bucket_size_histogram.size()) {
+        stats.bucket_size_histogram.resize(shard.bucket_size_histogram.size());
+      }
+      for (size_t length = 0; length < shard.bucket_size_histogram.size(); ++length) {
+        stats.bucket_size_histogram[length] += shard.bucket_size_histogram[length];
+      }
+      probes += shard.average_probe_length * shard.size;
+      stats.rehash_count += shard.rehash_count;
+      stats.rehash_time += shard.rehash_time;
+    }
+    size_t used_buckets = 0;
+    for (size_t length = 1; length < stats.bucket_size_histogram.size(); ++length) {
+      used_buckets += stats.bucket_size_histogram[length];
+    }
+    if (used_buckets != 0) {
+      stats.average_chain_length = double(stats.size) / used_buckets;
+    }
+    if (stats.size != 0) {
+      stats.average_probe_length = probes / stats.size;
+    }
+    return stats;
+  }
+};
+#endif  // CONCURRENT_UNORDERED_SET
@@ -0,0 +1,182 @@
+#ifndef FROZEN_UNORDERED_SET
+#define FROZEN_UNORDERED_SET
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class FrozenSetError : public std::runtime_error {
+ public:
+  explicit FrozenSetError(const std::string& what) : std::runtime_error("FrozenSetError: " + what) {
+  }
+};
+
+template <typename KeyT, typename Hash = std::hash<KeyT>, typename KeyEqual = std::equal_to<KeyT> >
+class FrozenUnorderedSet {
+  static_assert(std::is_trivially_copyable_v<KeyT>, "FrozenUnorderedSet stores keys as raw bytes");
+  static constexpr uint64_t kMagic = 0x315445534E5A5246ull;
+  static constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+  static constexpr size_t kAlignment = 64;
+  struct Header {
+    uint64_t magic;
+    uint64_t key_size;
+    uint64_t size;
+    uint64_t slot_count;
+    uint64_t keys_offset;
+    uint64_t file_size;
+  };
+  Hash hasher_;
+  KeyEqual equal_;
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  const Header* header_ = nullptr;
+  const uint8_t* tags_ = nullptr;
+  const KeyT* keys_ = nullptr;
+  unsigned shift_ = 64;
+  static size_t AlignUp(size_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+  }
+  static unsigned ShiftFor(uint64_t slot_count) {
+    unsigned shift = 64;
+    for (uint64_t i = slot_count; i > 1; i /= 2) {
+      --shift;
+    }
+    return shift;
+  }
+  static uint8_t TagOf(size_t hash) {
+    return static_cast<uint8_t>((static_cast<uint64_t>(hash) >> 57) | 0x80);
+  }
+  // every offset is checked against the file size before use, without overflowing
+  static bool Valid(const Header& header, size_t file_size) {
+    uint64_t slot_count = header.slot_count;
+    if (header.magic != kMagic || header.key_size != sizeof(KeyT) || header.file_size != file_size ||
+        slot_count < 2 || (slot_count & (slot_count - 1)) != 0 || header.size >= slot_count ||
+        header.keys_offset % alignof(KeyT) != 0 || header.keys_offset > file_size) {
+      return false;
+    }
+    uint64_t tags_offset = AlignUp(sizeof(Header));
+    return slot_count <= file_size && header.keys_offset >= tags_offset + slot_count &&
+           slot_count <= (file_size - header.keys_offset) / sizeof(KeyT);
+  }
+  FrozenUnorderedSet(void* mapping, size_t mapping_size) : mapping_(mapping), mapping_size_(mapping_size) {
+    header_ = static_cast<const Header*>(mapping_);
+    if (mapping_size_ < sizeof(Header) || !Valid(*header_, mapping_size_)) {
+      munmap(mapping_, mapping_size_);
+      mapping_ = nullptr;
+      throw FrozenSetError("corrupt or incompatible snapshot");
+    }
+    tags_ = reinterpret_cast<const uint8_t*>(header_) + AlignUp(sizeof(Header));
+    keys_ = reinterpret_cast<const KeyT*>(reinterpret_cast<const char*>(header_) + header_->keys_offset);
+    shift_ = ShiftFor(header_->slot_count);
+  }
+
+ public:
+  FrozenUnorderedSet(const FrozenUnorderedSet&) = delete;
+  FrozenUnorderedSet& operator=(const FrozenUnorderedSet&) = delete;
+  FrozenUnorderedSet(FrozenUnorderedSet&& other) noexcept {
+    *this = std::move(other);
+  }
+  FrozenUnorderedSet& operator=(FrozenUnorderedSet&& other) noexcept {
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+    std::swap(header_, other.header_);
+    std::swap(tags_, other.tags_);
+    std::swap(keys_, other.keys_);
+    std::swap(shift_, other.shift_);
+    return *this;
+  }
+  ~FrozenUnorderedSet() {
+    if (mapping_) {
+      munmap(mapping_, mapping_size_);
+    }
+  }
+  template <typename Set>
+  static void Write(const Set& set, const std::string& path) {
+    Hash hasher;
+    uint64_t slot_count = 8;
+    while (slot_count < 2 * set.Size()) {
+      slot_count *= 2;
+    }
+    Header header{kMagic, sizeof(KeyT), set.Size(), slot_count, 0, 0};
+    header.keys_offset = AlignUp(sizeof(Header)) + AlignUp(slot_count);
+    header.file_size = header.keys_offset + slot_count * sizeof(KeyT);
+    std::vector<char> buffer(header.file_size);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    auto tags = reinterpret_cast<uint8_t*>(buffer.data() + AlignUp(sizeof(Header)));
+    char* keys = buffer.data() + header.keys_offset;
+    unsigned shift = ShiftFor(slot_count);
+    for (const KeyT& key : set) {
+      size_t h = hasher(key);
+      uint64_t slot = (static_cast<uint64_t>(h) * kMultiplier) >> shift;
+      while (tags[slot] != 0) {
+        slot = (slot + 1) & (slot_count - 1);
+      }
+      tags[slot] = TagOf(h);
+      std::memcpy(keys + slot * sizeof(KeyT), &key, sizeof(KeyT));
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.close();
+    if (!out) {
+      throw FrozenSetError("cannot write " + path);
+    }
+  }
+  static FrozenUnorderedSet Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw FrozenSetError("cannot open " + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+      close(fd);
+      throw FrozenSetError("cannot stat " + path);
+    }
+    auto size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+      throw FrozenSetError("cannot map " + path);
+    }
+    return FrozenUnorderedSet(mapping, size);
+  }
+  // a moved-from set behaves as an empty one
+  size_t Size() const {
+    return header_ ? header_->size : 0;
+  }
+  bool Empty() const {
+    return Size() == 0;
+  }
+  size_t SlotCount() const {
+    return header_ ? header_->slot_count : 0;
+  }
+  bool Find(const KeyT& key) const {
+    if (!header_) {
+      return false;
+    }
+    size_t h = hasher_(key);
+    uint8_t tag = TagOf(h);
+    uint64_t mask = header_->slot_count - 1;
+    uint64_t slot = (static_cast<uint64_t>(h) * kMultiplier) >> shift_;
+    for (uint64_t probes = 0; tags_[slot] != 0 && probes <= mask; slot = (slot + 1) & mask, ++probes) {
+      if (tags_[slot] == tag && equal_(keys_[slot], key)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool Contains(const KeyT& key) const {
+    return Find(key);
+  }
+};
+#endif  // FROZEN_UNORDERED_SET
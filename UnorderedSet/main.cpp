@@ -3,12 +3,24 @@
 
 #include <iostream>
 #include <string>
+#include <cstdio>
+#include <filesystem>
 #include <forward_list>
+#include <iterator>
 #include <vector>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
 
 #include "unordered_set.h"
 #include "unordered_set.h"  // check include guards
+#include "concurrent_unordered_set.h"
+#include "concurrent_unordered_set.h"  // check include guards
+#include "unordered_map.h"
+#include "unordered_map.h"  // check include guards
+#include "frozen_unordered_set.h"
+#include "frozen_unordered_set.h"  // check include guards
 
 #define REQUIRE(X) if(!(X)) { std::cout << __LINE__ << " error\n"; }
 #define REQUIRE_FALSE(X) if((X)) { std::cout << __LINE__ << " error\n"; }
@@ -26,6 +38,51 @@ bool operator==(double l, const Approx& r) {
   return l >= r.val_ - 0.001 && l <= r.val_ + 0.001;
 }
 
+struct StringHash {
+  using is_transparent = void;  // NOLINT
+  size_t operator()(std::string_view str) const {
+    return std::hash<std::string_view>{}(str);
+  }
+};
+
+struct InstanceHash {
+  static int instances;
+  int id = ++instances;
+  size_t operator()(int key) const {
+    return std::hash<int>{}(key);
+  }
+};
+
+int InstanceHash::instances = 0;
+
+struct CopyCountingKey {
+  static int copies;
+  std::string value;
+  explicit CopyCountingKey(std::string str) : value(std::move(str)) {
+  }
+  CopyCountingKey(const CopyCountingKey& other) : value(other.value) {
+    ++copies;
+  }
+  CopyCountingKey(CopyCountingKey&& other) noexcept = default;
+  CopyCountingKey& operator=(const CopyCountingKey& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  CopyCountingKey& operator=(CopyCountingKey&& other) noexcept = default;
+  bool operator==(const CopyCountingKey& other) const {
+    return value == other.value;
+  }
+};
+
+int CopyCountingKey::copies = 0;
+
+struct CopyCountingKeyHash {
+  size_t operator()(const CopyCountingKey& key) const {
+    return std::hash<std::string>{}(key.value);
+  }
+};
+
 int main() {
 
 #define TEST_CASE(a, b) std::cout << a << " " << b << '\n';
@@ -357,6 +414,583 @@ TEST_CASE("Reserve", "[Bucket]") {
   }
 }
 
+TEST_CASE("Transparent", "[Usage]") {
+  UnorderedSet<std::string, StringHash, std::equal_to<> > us;
+  for (int i = 0; i < 10; ++i) {
+    us.Insert(std::to_string(i));
+  }
+  const std::string_view five = "5";
+  REQUIRE(us.Find(five));
+  REQUIRE(us.Contains("7"));
+  REQUIRE_FALSE(us.Find(std::string_view("10")));
+  us.Erase(five);
+  REQUIRE_FALSE(us.Contains(five));
+  REQUIRE(us.Size() == 9u);
+
+  const size_t hash = us.HashFunction()("3");
+  const UnorderedSet<std::string, StringHash, std::equal_to<> > other(us);
+  REQUIRE(us.Find(std::string_view("3"), hash));
+  REQUIRE(other.Contains("3", hash));
+  us.Erase("3", hash);
+  REQUIRE_FALSE(us.Find("3", hash));
+  REQUIRE(other.Find("3", hash));
+}
+
+TEST_CASE("PrecomputedHash", "[Usage]") {
+  UnorderedSet<std::string> us;
+  us.Insert("a");
+  const std::string key = "a";
+  const size_t hash = us.HashFunction()(key);
+  REQUIRE(us.Find(key, hash));
+  REQUIRE(us.Contains(key, hash));
+  us.Erase(key, hash);
+  REQUIRE_FALSE(us.Find(key));
+}
+
+TEST_CASE("IncrementalRehash", "[Bucket]") {
+  UnorderedSet<int> us;
+  us.SetRehashStep(1u);
+  REQUIRE(us.RehashStep() == 1u);
+  bool rehashing_seen = false;
+  for (int i = 0; i < 1000; ++i) {
+    us.Insert(i);
+    rehashing_seen = rehashing_seen || us.Rehashing();
+    REQUIRE(us.Find(i));
+    REQUIRE(us.Find(i / 2));
+    REQUIRE_FALSE(us.Find(i + 1));
+  }
+  REQUIRE(rehashing_seen);
+  REQUIRE(us.Size() == 1000u);
+  REQUIRE(us.BucketCount() == 1024u);
+
+  us.Insert(1000);
+  REQUIRE(us.Rehashing());
+  for (int i = 0; i < 1001; i += 2) {
+    us.Erase(i);
+  }
+  REQUIRE(us.Size() == 500u);
+  for (int i = 0; i < 1001; ++i) {
+    REQUIRE(us.Find(i) == (i % 2 == 1));
+  }
+
+  us.SetRehashStep(0u);
+  REQUIRE_FALSE(us.Rehashing());
+  size_t bucket_size_sum = 0;
+  for (size_t i = 0u; i < us.BucketCount(); ++i) {
+    bucket_size_sum += us.BucketSize(i);
+  }
+  REQUIRE(bucket_size_sum == 500u);
+
+  us.Insert(2000);
+  us.Reserve(4096u);
+  REQUIRE_FALSE(us.Rehashing());
+  REQUIRE(us.BucketCount() == 4096u);
+  REQUIRE(us.Find(2000));
+}
+
+TEST_CASE("Concurrent", "[ConcurrentUnorderedSet]") {
+  ConcurrentUnorderedSet<int> us(6u);
+  REQUIRE(us.ShardCount() == 8u);
+  REQUIRE(us.Empty());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&us, t] {
+      for (int i = 0; i < 1000; ++i) {
+        us.Insert(t * 1000 + i);
+        us.Insert(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  REQUIRE(us.Size() == 4000u);
+  REQUIRE_FALSE(us.Insert(3999));
+
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&us, t] {
+      for (int i = t; i < 4000; i += 4) {
+        if (i % 2 == 0) {
+          us.Erase(i);
+        } else {
+          us.Find(i);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(us.Size() == 2000u);
+  for (int i = 0; i < 4000; ++i) {
+    REQUIRE(us.Contains(i) == (i % 2 == 1));
+  }
+  REQUIRE_FALSE(us.Erase(0));
+
+  us.Clear();
+  REQUIRE(us.Empty());
+  REQUIRE_FALSE(us.Find(1));
+
+  ConcurrentUnorderedSet<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, PowerOfTwoBucketPolicy> spread(64u);
+  for (uint64_t i = 0; i < 100000; ++i) {
+    REQUIRE(spread.Insert(i * 7));
+  }
+  HashTableStats stats = spread.Stats();
+  REQUIRE(stats.size == 100000u);
+  REQUIRE(stats.average_chain_length < 2);
+  REQUIRE(stats.max_chain_length < 8u);
+  REQUIRE(spread.Contains(700));
+  REQUIRE_FALSE(spread.Contains(701));
+}
+
+TEST_CASE("BulkOperations", "[Usage]") {
+  {
+    std::forward_list<int> fl{5, 1, 2, 3, 4};
+    const UnorderedSet<int> us(fl.begin(), fl.end());
+    REQUIRE(us.Size() == 5u);
+    REQUIRE(us.BucketCount() == 5u);
+
+    const std::forward_list<int> empty;
+    const UnorderedSet<int> empty_us(empty.begin(), empty.end());
+    REQUIRE(empty_us.Empty());
+    REQUIRE(empty_us.BucketCount() == 0u);
+  }
+
+  {
+    std::vector<int> keys(100);
+    for (int i = 0; i < 100; ++i) {
+      keys[i] = i;
+    }
+    auto us = UnorderedSet<int>::FromRange(keys.begin(), keys.end());
+    REQUIRE(us.Size() == 100u);
+    REQUIRE(us.BucketCount() == 100u);
+    us.InsertRange(keys.begin(), keys.begin() + 50);
+    REQUIRE(us.BucketCount() == 150u);
+
+    std::istringstream iss("200 201 202");
+    us.InsertRange(std::istream_iterator<int>(iss), std::istream_iterator<int>());
+    REQUIRE(us.Size() == 153u);
+    REQUIRE(us.Find(202));
+  }
+
+  {
+    UnorderedSet<int> us;
+    for (int i = 0; i < 100; i += 3) {
+      us.Insert(i);
+    }
+    std::vector<int> probes(100);
+    for (int i = 0; i < 100; ++i) {
+      probes[i] = i;
+    }
+    uint64_t found[2] = {~uint64_t(0), ~uint64_t(0)};
+    us.FindBatch(probes.data(), probes.size(), found);
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(((found[i / 64] >> (i % 64)) & 1u) == (i % 3 == 0 ? 1u : 0u));
+    }
+    REQUIRE((found[1] >> 36) == 0u);
+  }
+}
+
+TEST_CASE("DenseStorage", "[UnorderedSet]") {
+  UnorderedSet<std::string> us;
+  for (int i = 0; i < 5; ++i) {
+    us.Insert(std::to_string(i));
+  }
+  std::string order;
+  for (const auto& key : us) {
+    order += key;
+  }
+  REQUIRE(order == "01234");
+  REQUIRE(us.end() - us.begin() == 5);
+
+  us.Erase("1");
+  order.clear();
+  for (auto it = us.cbegin(); it != us.cend(); ++it) {
+    order += *it;
+  }
+  REQUIRE(order == "0423");
+
+  std::unordered_set<int> expected;
+  UnorderedSet<int> incremental;
+  incremental.SetRehashStep(2u);
+  for (int i = 0; i < 5000; ++i) {
+    const int key = (i * 7919) % 1013;
+    if (i % 3 == 2) {
+      expected.erase(key);
+      incremental.Erase(key);
+    } else if (!incremental.Find(key)) {
+      expected.insert(key);
+      incremental.Insert(key);
+    }
+    REQUIRE(incremental.Size() == expected.size());
+  }
+  for (int key = 0; key < 1013; ++key) {
+    REQUIRE(incremental.Find(key) == (expected.count(key) == 1u));
+  }
+  size_t scanned = 0;
+  for (int key : incremental) {
+    scanned += expected.count(key);
+  }
+  REQUIRE(scanned == expected.size());
+
+  UnorderedSet<int> segmented;
+  segmented.Insert(0);
+  const int* first = &*segmented.begin();
+  for (int i = 1; i < 5000; ++i) {
+    segmented.Insert(i);
+  }
+  REQUIRE(&*segmented.begin() == first);
+  REQUIRE(segmented.end() - segmented.begin() == 5000);
+  auto it = segmented.begin() + 1023;
+  REQUIRE(*it == 1023);
+  REQUIRE(*++it == 1024);
+  REQUIRE(*--it == 1023);
+  REQUIRE(it[2049] == 3072);
+  REQUIRE(*(segmented.end() - 1) == 4999);
+  REQUIRE(*(it - 1000) == 23);
+  REQUIRE((it < it + 1 && it + 1 > it && it <= it && segmented.end() - it == 3977));
+  int previous = 5000;
+  for (auto back = segmented.end(); back != segmented.begin();) {
+    REQUIRE(*--back == --previous);
+  }
+  REQUIRE(previous == 0);
+}
+
+TEST_CASE("Aliasing", "[UnorderedSet]") {
+  for (size_t step : {0u, 2u}) {
+    UnorderedSet<std::string> us;
+    us.SetRehashStep(step);
+    for (int i = 0; us.Size() < us.BucketCount() || us.Size() < 8u; ++i) {
+      us.Insert(std::string(32, static_cast<char>('a' + i)));
+    }
+    const size_t bucket_count = us.BucketCount();
+    us.Insert(*us.begin());
+    REQUIRE((us.BucketCount() > bucket_count || us.Rehashing()));
+    REQUIRE(*(us.end() - 1) == std::string(32, 'a'));
+    REQUIRE(*us.begin() == std::string(32, 'a'));
+  }
+
+  UnorderedSet<int> sparse;
+  sparse.Rehash(1u << 16);
+  sparse.Insert(1);
+  REQUIRE(sparse.Stats().bytes_allocated < (1u << 16) * sizeof(size_t) + (1u << 15));
+  sparse.Reserve(1u << 17);
+  REQUIRE(sparse.Stats().bytes_allocated >= (1u << 17) * (sizeof(size_t) + sizeof(int)));
+
+  UnorderedSet<int, InstanceHash> source;
+  source.EnableStats();
+  for (int i = 0; i < 10; ++i) {
+    source.Insert(i);
+  }
+  const int source_id = source.HashFunction().id;
+  UnorderedSet<int, InstanceHash> target;
+  REQUIRE(target.HashFunction().id != source_id);
+  target = std::move(source);
+  REQUIRE(target.HashFunction().id == source_id);
+  REQUIRE(target.Stats().rehash_count == 5u);
+  target.Insert(10);
+  REQUIRE(target.Find(10));
+}
+
+TEST_CASE("UnorderedMap", "[UnorderedMap]") {
+  UnorderedMap<std::string, std::vector<int> > um;
+  REQUIRE(um.Empty());
+
+  auto [it, inserted] = um.TryEmplace("a", 3u, 7);
+  REQUIRE(inserted);
+  REQUIRE(it->first == "a");
+  REQUIRE(it->second == std::vector<int>(3u, 7));
+  REQUIRE_FALSE(um.TryEmplace("a", 1u, 1).second);
+  REQUIRE(um.Find("a")->second.size() == 3u);
+
+  um["b"].push_back(1);
+  um["b"].push_back(2);
+  REQUIRE(um.Size() == 2u);
+  REQUIRE(um["b"] == (std::vector<int>{1, 2}));
+
+  REQUIRE_FALSE(um.InsertOrAssign("b", std::vector<int>{5}).second);
+  REQUIRE(um.Find("b")->second == std::vector<int>{5});
+  REQUIRE(um.InsertOrAssign("c", std::vector<int>{6}).second);
+  REQUIRE_FALSE(um.Insert({"c", {}}).second);
+  REQUIRE(um.Insert({"d", {}}).second);
+  REQUIRE(um.Size() == 4u);
+
+  auto node = um.Extract("a");
+  REQUIRE_FALSE(node.Empty());
+  REQUIRE(node.Key() == "a");
+  REQUIRE(node.Mapped() == std::vector<int>(3u, 7));
+  REQUIRE_FALSE(um.Contains("a"));
+  REQUIRE(um.Size() == 3u);
+  REQUIRE(um.Extract("a").Empty());
+
+  node.Key() = "e";
+  REQUIRE(um.Insert(std::move(node)).second);
+  REQUIRE(node.Empty());
+  REQUIRE(um.Find("e")->second == std::vector<int>(3u, 7));
+
+  um.Erase("b");
+  REQUIRE(um.Find("b") == um.end());
+  size_t total = 0;
+  for (const auto& [key, value] : um) {
+    total += key.size() + value.size();
+  }
+  REQUIRE(total == 3u + 1u + 0u + 3u);
+
+  const auto copy = um;
+  REQUIRE(copy.Size() == 3u);
+  REQUIRE(copy.Find("c")->second == std::vector<int>{6});
+  REQUIRE(copy.Find("b") == copy.end());
+
+  for (size_t step : {0u, 2u}) {
+    UnorderedMap<std::string, std::string> aliased;
+    aliased.SetRehashStep(step);
+    for (int i = 0; aliased.Size() < aliased.BucketCount() || aliased.Size() < 8u; ++i) {
+      aliased[std::string(32, static_cast<char>('a' + i))] = std::string(32, static_cast<char>('A' + i));
+    }
+    size_t bucket_count = aliased.BucketCount();
+    aliased[aliased.begin()->second] = "x";
+    REQUIRE((aliased.BucketCount() > bucket_count || aliased.Rehashing()));
+    REQUIRE(aliased.Find(std::string(32, 'A'))->second == "x");
+    while (aliased.Size() < aliased.BucketCount()) {
+      aliased[std::to_string(aliased.Size())];
+    }
+    bucket_count = aliased.BucketCount();
+    auto [pos, added] = aliased.TryEmplace(aliased.begin()->second + "!", aliased.begin()->first);
+    REQUIRE(added);
+    REQUIRE((aliased.BucketCount() > bucket_count || aliased.Rehashing()));
+    REQUIRE(pos->first == std::string(32, 'A') + "!");
+    REQUIRE(pos->second == std::string(32, 'a'));
+    auto extracted = aliased.Extract(std::string(32, 'a'));
+    REQUIRE(extracted.Key() == std::string(32, 'a'));
+    REQUIRE(extracted.Mapped() == std::string(32, 'A'));
+    REQUIRE(aliased.Find(std::string(32, 'A') + "!")->second == std::string(32, 'a'));
+  }
+
+  UnorderedMap<CopyCountingKey, int, CopyCountingKeyHash> churn;
+  for (int i = 0; i < 3000; ++i) {
+    churn.TryEmplace(CopyCountingKey(std::string(32, 'k') + std::to_string(i)), i);
+  }
+  CopyCountingKey::copies = 0;
+  for (int i = 0; i < 1000; ++i) {
+    auto extracted_key = churn.Extract(CopyCountingKey(std::string(32, 'k') + std::to_string(i)));
+    REQUIRE(churn.Insert(std::move(extracted_key)).second);
+    churn.Erase(CopyCountingKey(std::string(32, 'k') + std::to_string(2000 + i)));
+  }
+  REQUIRE(CopyCountingKey::copies == 0);
+  REQUIRE(churn.Size() == 2000u);
+  for (int i = 0; i < 3000; ++i) {
+    auto found = churn.Find(CopyCountingKey(std::string(32, 'k') + std::to_string(i)));
+    REQUIRE((i < 2000 ? found != churn.end() && found->second == i : found == churn.end()));
+  }
+
+  UnorderedMap<std::string, int> assigned;
+  assigned["stale"] = -1;
+  UnorderedMap<std::string, int> source;
+  for (int i = 0; i < 3000; ++i) {
+    source[std::to_string(i)] = i;
+  }
+  assigned = source;
+  REQUIRE(assigned.Size() == 3000u);
+  REQUIRE_FALSE(assigned.Contains("stale"));
+  REQUIRE(assigned.Find("2999")->second == 2999);
+  assigned.Erase("0");
+  REQUIRE(source.Contains("0"));
+  const auto& const_source = source;
+  UnorderedMap<std::string, int>::ConstIterator first = source.begin();
+  REQUIRE(first == const_source.begin());
+  std::pair<const std::string, int> copied = *first;
+  REQUIRE(copied.second == source.Find(copied.first)->second);
+}
+
+TEST_CASE("BloomFilter", "[Filter]") {
+  {
+    BlockedBloomFilter filter(1000u);
+    REQUIRE(filter.BlockCount() == 20u);
+    for (size_t i = 0; i < 1000u; ++i) {
+      filter.Add(i);
+    }
+    size_t false_positives = 0;
+    for (size_t i = 0; i < 1000u; ++i) {
+      REQUIRE(filter.MayContain(i));
+      false_positives += filter.MayContain(i + 1000u);
+    }
+    REQUIRE(false_positives < 50u);
+    filter.Clear();
+    REQUIRE_FALSE(filter.MayContain(0u));
+  }
+
+  {
+    UnorderedSet<int> us;
+    REQUIRE(us.Filter() == nullptr);
+    us.Insert(1);
+    us.AttachFilter(100u);
+    REQUIRE(us.Filter() != nullptr);
+    for (int i = 2; i < 100; ++i) {
+      us.Insert(i);
+    }
+    us.Erase(50);
+    for (int i = 0; i < 200; ++i) {
+      REQUIRE(us.Find(i) == (i > 0 && i < 100 && i != 50));
+    }
+    const auto copy = us;
+    REQUIRE(copy.Filter() != nullptr);
+    REQUIRE(copy.Find(99));
+    us.Clear();
+    REQUIRE_FALSE(us.Find(1));
+    us.DetachFilter();
+    REQUIRE(us.Filter() == nullptr);
+  }
+}
+
+TEST_CASE("Stats", "[Bucket]") {
+  UnorderedSet<int> us;
+  us.EnableStats();
+  for (int i = 0; i < 10; ++i) {
+    us.Insert(i * 16);
+  }
+  auto stats = us.Stats();
+  REQUIRE(stats.size == 10u);
+  REQUIRE(stats.bucket_count == 16u);
+  REQUIRE(stats.rehash_count == 5u);
+  REQUIRE(stats.bytes_allocated >= 16u * sizeof(size_t) + 10u * sizeof(int));
+  REQUIRE(stats.max_chain_length == 10u);
+  REQUIRE(stats.average_chain_length == Approx(10.0));
+  REQUIRE(stats.average_probe_length == Approx(5.5));
+  REQUIRE(stats.bucket_size_histogram.size() == 11u);
+  REQUIRE(stats.bucket_size_histogram[0] == 15u);
+  REQUIRE(stats.bucket_size_histogram[10] == 1u);
+
+  us.EnableStats(false);
+  us.Rehash(64u);
+  stats = us.Stats();
+  REQUIRE(stats.rehash_count == 5u);
+  REQUIRE(stats.max_chain_length == 3u);
+  REQUIRE(stats.average_probe_length == Approx(1.8));
+
+  us.AttachFilter(100u);
+  REQUIRE(us.Stats().bytes_allocated == stats.bytes_allocated + us.Filter()->MemoryUsage());
+}
+
+TEST_CASE("Frozen", "[FrozenUnorderedSet]") {
+  const auto path = (std::filesystem::temp_directory_path() / "frozen_unordered_set_test.bin").string();
+  {
+    UnorderedSet<uint64_t> us;
+    for (uint64_t i = 0; i < 1000; ++i) {
+      us.Insert(i * 3);
+    }
+    FrozenUnorderedSet<uint64_t>::Write(us, path);
+  }
+
+  {
+    auto frozen = FrozenUnorderedSet<uint64_t>::Open(path);
+    REQUIRE(frozen.Size() == 1000u);
+    REQUIRE_FALSE(frozen.Empty());
+    REQUIRE(frozen.SlotCount() == 2048u);
+    for (uint64_t i = 0; i < 3000; ++i) {
+      REQUIRE(frozen.Find(i) == (i % 3 == 0));
+    }
+    const auto moved = std::move(frozen);
+    REQUIRE(moved.Contains(999u * 3));
+  }
+
+  {
+    const UnorderedSet<uint64_t> empty;
+    FrozenUnorderedSet<uint64_t>::Write(empty, path);
+    const auto frozen = FrozenUnorderedSet<uint64_t>::Open(path);
+    REQUIRE(frozen.Empty());
+    REQUIRE_FALSE(frozen.Find(0u));
+  }
+
+  REQUIRE_THROWS_AS(FrozenUnorderedSet<uint32_t>::Open(path), FrozenSetError);
+
+  {
+    const auto moved_from = [&] {
+      auto frozen = FrozenUnorderedSet<uint64_t>::Open(path);
+      auto target = std::move(frozen);
+      return frozen;
+    }();
+    REQUIRE(moved_from.Empty());
+    REQUIRE(moved_from.SlotCount() == 0u);
+    REQUIRE_FALSE(moved_from.Find(0u));
+  }
+
+  // header fields: magic, key_size, size, slot_count, keys_offset, file_size
+  auto corrupt = [&path](size_t field, uint64_t value) {
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    std::fseek(file, static_cast<long>(field * sizeof(uint64_t)), SEEK_SET);
+    std::fwrite(&value, sizeof(value), 1, file);
+    std::fclose(file);
+  };
+  const std::pair<size_t, uint64_t> corruptions[] = {{3, uint64_t(1) << 40}, {3, 12}, {3, 0}, {3, 1}, {4, 8},
+                                                      {4, ~uint64_t(0) - 7}, {4, 64 + 8 + 4}, {4, 192 - 8}, {2, 8}};
+  for (const auto& [field, value] : corruptions) {
+    FrozenUnorderedSet<uint64_t>::Write(UnorderedSet<uint64_t>(), path);
+    corrupt(field, value);
+    REQUIRE_THROWS_AS(FrozenUnorderedSet<uint64_t>::Open(path), FrozenSetError);
+  }
+
+  REQUIRE_THROWS_AS(FrozenUnorderedSet<uint64_t>::Write(UnorderedSet<uint64_t>(), "/dev/full"),
+                    FrozenSetError);
+  std::remove(path.c_str());
+  REQUIRE_THROWS_AS(FrozenUnorderedSet<uint64_t>::Open(path), FrozenSetError);
+}
+
+TEST_CASE("BucketPolicy", "[Bucket]") {
+  {
+    UnorderedSet<int, std::hash<int>, std::equal_to<int>, PowerOfTwoBucketPolicy> us(5u);
+    REQUIRE(us.BucketCount() == 8u);
+    for (int i = 0; i < 1000; ++i) {
+      us.Insert(i * 1024);
+    }
+    REQUIRE(us.Size() == 1000u);
+    REQUIRE(us.BucketCount() == 1024u);
+    size_t max_bucket_size = 0;
+    for (size_t i = 0u; i < us.BucketCount(); ++i) {
+      max_bucket_size = std::max(max_bucket_size, us.BucketSize(i));
+    }
+    REQUIRE(max_bucket_size < 8u);
+    for (int i = 0; i < 1000; ++i) {
+      REQUIRE(us.Bucket(i * 1024) < us.BucketCount());
+      REQUIRE(us.Find(i * 1024));
+      REQUIRE_FALSE(us.Find(i * 1024 + 1));
+    }
+    us.Erase(0);
+    REQUIRE_FALSE(us.Find(0));
+    REQUIRE(us.Size() == 999u);
+  }
+
+  {
+    UnorderedSet<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, FastModBucketPolicy> us;
+    us.Rehash(100u);
+    REQUIRE(us.BucketCount() == 101u);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      us.Insert(i * 0x100000001ull);
+    }
+    size_t max_bucket_size = 0;
+    for (size_t i = 0; i < us.BucketCount(); ++i) {
+      max_bucket_size = std::max(max_bucket_size, us.BucketSize(i));
+    }
+    REQUIRE(max_bucket_size == 1u);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      const uint64_t key = i * 0x100000001ull;
+      REQUIRE(us.Bucket(key) == key % us.BucketCount());
+      REQUIRE(us.Find(key));
+      REQUIRE_FALSE(us.Find(key + 1));
+    }
+    REQUIRE(us.Bucket(0x100000001ull) != us.Bucket(2 * 0x100000001ull));
+
+    FastModBucketPolicy policy;
+    const uint64_t large_prime = (uint64_t(1) << 61) - 1;
+    policy.Reset(large_prime);
+    for (uint64_t key : {uint64_t(0), large_prime - 1, large_prime, large_prime + 1, ~uint64_t(0),
+                         uint64_t(0x9E3779B97F4A7C15ull), uint64_t(0x123456789ABCDEFull)}) {
+      REQUIRE(policy.Index(key) == key % large_prime);
+    }
+  }
+}
+
 #ifdef ITERATOR_IMPLEMENTED
 
 TEST_CASE("Iterators", "[UnorderedSet]") {
@@ -0,0 +1,173 @@
+#ifndef UNORDERED_MAP
+#define UNORDERED_MAP
+
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "unordered_set.h"
+
+namespace detail {  // NOLINT
+
+// const-key view of a stored std::pair<K, V>: the table keeps the key mutable so that erasing
+// can move the last element into the hole instead of copying its key
+template <typename K, typename V>
+struct KeyValueRef {
+  const K& first;
+  V& second;
+
+  explicit KeyValueRef(std::pair<K, std::remove_const_t<V> >& stored) : first(stored.first), second(stored.second) {
+  }
+  operator std::pair<const K, std::remove_const_t<V> >() const {  // NOLINT
+    return {first, second};
+  }
+};
+
+}  // namespace detail
+
+template <typename KeyT, typename ValueT, typename Hash = std::hash<KeyT>, typename KeyEqual = std::equal_to<KeyT>,
+          typename BucketPolicy = ModuloBucketPolicy>
+class UnorderedMap
+    : public detail::HashTable<std::pair<KeyT, ValueT>, KeyT, detail::First, Hash, KeyEqual, BucketPolicy> {
+  using Base = detail::HashTable<std::pair<KeyT, ValueT>, KeyT, detail::First, Hash, KeyEqual, BucketPolicy>;
+  using StoredType = std::pair<KeyT, ValueT>;
+  template <typename K, typename... Args>
+  auto TryEmplaceImpl(K&& key, Args&&... args) {
+    size_t h = this->hasher_(key);
+    size_t index = this->FindIndex(key, h);
+    if (index != Base::kNone) {
+      return std::make_pair(begin() + index, false);
+    }
+    index = this->EmplaceImpl(h, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+    return std::make_pair(begin() + index, true);
+  }
+
+ public:
+  using ValueType = std::pair<const KeyT, ValueT>;
+  using DifferenceType = std::ptrdiff_t;
+  using Iterator = detail::SegmentIterator<StoredType, ValueType, detail::KeyValueRef<KeyT, ValueT> >;
+  using ConstIterator = detail::SegmentIterator<StoredType, const ValueType, detail::KeyValueRef<KeyT, const ValueT> >;
+  class Node {
+    friend class UnorderedMap;
+    std::optional<std::pair<KeyT, ValueT> > value_;
+
+   public:
+    bool Empty() const {
+      return !value_.has_value();
+    }
+    explicit operator bool() const {
+      return value_.has_value();
+    }
+    KeyT& Key() {
+      return value_->first;
+    }
+    ValueT& Mapped() {
+      return value_->second;
+    }
+  };
+  UnorderedMap() = default;
+  explicit UnorderedMap(size_t count) {
+    this->Rehash(count);
+  }
+  Iterator begin() {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  Iterator end() {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  ConstIterator begin() const {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  ConstIterator end() const {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  ConstIterator cbegin() const {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  ConstIterator cend() const {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  template <typename... Args>
+  std::pair<Iterator, bool> TryEmplace(const KeyT& key, Args&&... args) {
+    return TryEmplaceImpl(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<Iterator, bool> TryEmplace(KeyT&& key, Args&&... args) {
+    return TryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+  }
+  template <typename M>
+  std::pair<Iterator, bool> InsertOrAssign(const KeyT& key, M&& value) {
+    auto result = TryEmplaceImpl(key, std::forward<M>(value));
+    if (!result.second) {
+      result.first->second = std::forward<M>(value);
+    }
+    return result;
+  }
+  template <typename M>
+  std::pair<Iterator, bool> InsertOrAssign(KeyT&& key, M&& value) {
+    auto result = TryEmplaceImpl(std::move(key), std::forward<M>(value));
+    if (!result.second) {
+      result.first->second = std::forward<M>(value);
+    }
+    return result;
+  }
+  std::pair<Iterator, bool> Insert(const ValueType& value) {
+    return TryEmplaceImpl(value.first, value.second);
+  }
+  std::pair<Iterator, bool> Insert(Node&& node) {
+    if (node.Empty()) {
+      return {end(), false};
+    }
+    size_t h = this->hasher_(node.Key());
+    size_t index = this->FindIndex(node.Key(), h);
+    if (index != Base::kNone) {
+      return {begin() + index, false};
+    }
+    index = this->EmplaceImpl(h, std::move(node.Key()), std::move(node.Mapped()));
+    node.value_.reset();
+    return {begin() + index, true};
+  }
+  Node Extract(const KeyT& key) {
+    Node node;
+    size_t index = this->FindIndex(key, this->hasher_(key));
+    if (index != Base::kNone) {
+      node.value_.emplace(std::move(this->values_[index]));
+      this->Unlink(index);
+    }
+    return node;
+  }
+  ValueT& operator[](const KeyT& key) {
+    return TryEmplaceImpl(key).first->second;
+  }
+  ValueT& operator[](KeyT&& key) {
+    return TryEmplaceImpl(std::move(key)).first->second;
+  }
+  void Erase(const KeyT& key) {
+    this->EraseImpl(key, this->hasher_(key));
+  }
+  void Erase(const KeyT& key, size_t hash) {
+    this->EraseImpl(key, hash);
+  }
+  Iterator Find(const KeyT& key) {
+    return Find(key, this->hasher_(key));
+  }
+  Iterator Find(const KeyT& key, size_t hash) {
+    size_t index = this->FindIndex(key, hash);
+    return index == Base::kNone ? end() : begin() + index;
+  }
+  ConstIterator Find(const KeyT& key) const {
+    return Find(key, this->hasher_(key));
+  }
+  ConstIterator Find(const KeyT& key, size_t hash) const {
+    size_t index = this->FindIndex(key, hash);
+    return index == Base::kNone ? end() : begin() + index;
+  }
+  bool Contains(const KeyT& key) const {
+    return this->FindIndex(key, this->hasher_(key)) != Base::kNone;
+  }
+  bool Contains(const KeyT& key, size_t hash) const {
+    return this->FindIndex(key, hash) != Base::kNone;
+  }
+};
+#endif  // UNORDERED_MAP
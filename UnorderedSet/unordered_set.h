@@ -1,124 +1,716 @@
 #ifndef UNORDERED_SET
 #define UNORDERED_SET
+#define ITERATOR_IMPLEMENTED
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <functional>
-#include <list>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template <typename KeyT, typename Hash = std::hash<KeyT>, typename KeyEqual = std::equal_to<KeyT> >
-class UnorderedSet {
-  Hash hasher_;
-  KeyEqual equal_;
-  std::vector<std::list<KeyT> > buckets_;
-  size_t size_ = 0;
-  size_t bucket_count_ = 0;
+#include "bloom_filter.h"
+
+namespace detail {  // NOLINT
+
+template <typename T, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename T>
+struct IsTransparent<T, std::void_t<typename T::is_transparent> > : std::true_type {};
+
+struct Identity {
+  template <typename T>
+  const T& operator()(const T& value) const {
+    return value;
+  }
+};
+
+struct First {
+  template <typename T>
+  const auto& operator()(const T& value) const {
+    return value.first;
+  }
+};
+
+// operator-> for iterators whose reference is a proxy object rather than a real reference
+template <typename Reference>
+struct ArrowProxy {
+  Reference reference;
+  Reference* operator->() {
+    return &reference;
+  }
+};
 
+// Elements live in fixed-size segments that never move, so growing allocates one segment
+// instead of copying every element
+template <typename T>
+class SegmentedArray {
  public:
-  UnorderedSet() = default;
-  explicit UnorderedSet(size_t count) : buckets_(count), bucket_count_(count) {
+  static constexpr size_t kSegmentShift = 10;
+  static constexpr size_t kSegmentSize = size_t(1) << kSegmentShift;
+
+ private:
+  std::vector<T*> segments_;
+  size_t size_ = 0;
+
+  T* Slot(size_t index) const {
+    return segments_[index >> kSegmentShift] + (index & (kSegmentSize - 1));
   }
-  template <typename Iter>
-  UnorderedSet(const Iter& begin, const Iter& end) {
-    Reserve(std::count(begin, end, *begin));
-    for (Iter i = begin; i != end; ++i) {
-      Insert(*i);
+  void AddSegment() {
+    segments_.push_back(nullptr);
+    try {
+      segments_.back() = std::allocator<T>().allocate(kSegmentSize);
+    } catch (...) {
+      segments_.pop_back();
+      throw;
     }
   }
-  UnorderedSet(const UnorderedSet& other) = default;
-  UnorderedSet(UnorderedSet&& other) {
-    buckets_ = std::move(other.buckets_);
-    size_ = other.size_;
-    bucket_count_ = other.bucket_count_;
-    other.size_ = 0;
-    other.bucket_count_ = 0;
+
+ public:
+  SegmentedArray() = default;
+  SegmentedArray(const SegmentedArray& other) : SegmentedArray() {
+    reserve(other.size_);
+    for (size_t i = 0; i < other.size_; ++i) {
+      emplace_back(other[i]);
+    }
   }
-  UnorderedSet& operator=(const UnorderedSet& other) = default;
-  UnorderedSet& operator=(UnorderedSet&& other) {
-    buckets_ = std::move(other.buckets_);
-    size_ = other.size_;
-    bucket_count_ = other.bucket_count_;
-    other.size_ = 0;
-    other.bucket_count_ = 0;
+  SegmentedArray(SegmentedArray&& other) noexcept : SegmentedArray() {
+    swap(other);
+  }
+  SegmentedArray& operator=(const SegmentedArray& other) {
+    SegmentedArray tmp(other);
+    swap(tmp);
     return *this;
   }
-  ~UnorderedSet() = default;
-  size_t Size() const {
+  SegmentedArray& operator=(SegmentedArray&& other) noexcept {
+    SegmentedArray tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+  ~SegmentedArray() {
+    clear();
+    for (T* segment : segments_) {
+      std::allocator<T>().deallocate(segment, kSegmentSize);
+    }
+  }
+  T* const* segments() const {
+    return segments_.data();
+  }
+  size_t size() const {
     return size_;
   }
-  bool Empty() const {
+  bool empty() const {
     return size_ == 0;
   }
-  void Clear() {
-    buckets_.clear();
-    size_ = 0;
-    bucket_count_ = 0;
+  size_t capacity() const {
+    return segments_.size() * kSegmentSize;
   }
-  void Insert(const KeyT& key) {
-    size_t h = hasher_(key);
-    if (size_ + 1 > bucket_count_) {
-      Reserve(bucket_count_ == 0 ? 1 : bucket_count_ * 2);
+  T& operator[](size_t index) {
+    return *Slot(index);
+  }
+  const T& operator[](size_t index) const {
+    return *Slot(index);
+  }
+  T& back() {
+    return *Slot(size_ - 1);
+  }
+  void reserve(size_t count) {
+    segments_.reserve((count + kSegmentSize - 1) >> kSegmentShift);
+    while (capacity() < count) {
+      AddSegment();
     }
-    buckets_[h % bucket_count_].emplace_back(key);
-    ++size_;
   }
-  void Insert(KeyT&& key) {
-    size_t h = hasher_(key);
-    if (size_ + 1 > bucket_count_) {
-      Reserve(bucket_count_ == 0 ? 1 : bucket_count_ * 2);
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity()) {
+      AddSegment();
     }
-    buckets_[h % bucket_count_].emplace_back(std::move(key));
+    T* slot = new (Slot(size_)) T(std::forward<Args>(args)...);
     ++size_;
+    return *slot;
   }
-  void Erase(const KeyT& key) {
+  void pop_back() {
+    Slot(--size_)->~T();
+  }
+  void clear() {
+    while (size_ != 0) {
+      pop_back();
+    }
+  }
+  void swap(SegmentedArray& other) noexcept {
+    segments_.swap(other.segments_);
+    std::swap(size_, other.size_);
+  }
+};
+
+// Random-access iterator over a SegmentedArray; a full scan walks each segment sequentially
+template <typename Stored, typename Value, typename Reference = Value&>
+class SegmentIterator {
+  template <typename, typename, typename>
+  friend class SegmentIterator;
+  static constexpr std::ptrdiff_t kSegmentSize = SegmentedArray<Stored>::kSegmentSize;
+  Stored* const* segment_ = nullptr;
+  std::ptrdiff_t offset_ = 0;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::remove_cv_t<Value>;
+  using difference_type = std::ptrdiff_t;
+  using reference = Reference;
+  using pointer =
+      std::conditional_t<std::is_reference_v<Reference>, std::remove_reference_t<Reference>*, ArrowProxy<Reference> >;
+
+  SegmentIterator() = default;
+  SegmentIterator(Stored* const* segments, size_t index)
+      : segment_(segments + (index >> SegmentedArray<Stored>::kSegmentShift)),
+        offset_(static_cast<std::ptrdiff_t>(index) & (kSegmentSize - 1)) {
+  }
+  template <typename OtherValue, typename OtherReference,
+            typename = std::enable_if_t<!std::is_same_v<OtherValue, Value> &&
+                                        std::is_same_v<const OtherValue, Value> > >
+  SegmentIterator(const SegmentIterator<Stored, OtherValue, OtherReference>& other)  // NOLINT
+      : segment_(other.segment_), offset_(other.offset_) {
+  }
+  Reference operator*() const {
+    return static_cast<Reference>((*segment_)[offset_]);
+  }
+  pointer operator->() const {
+    if constexpr (std::is_reference_v<Reference>) {
+      return &**this;
+    } else {
+      return pointer{**this};
+    }
+  }
+  Reference operator[](difference_type n) const {
+    return *(*this + n);
+  }
+  SegmentIterator& operator++() {
+    if (++offset_ == kSegmentSize) {
+      ++segment_;
+      offset_ = 0;
+    }
+    return *this;
+  }
+  SegmentIterator operator++(int) {
+    SegmentIterator copy = *this;
+    ++*this;
+    return copy;
+  }
+  SegmentIterator& operator--() {
+    if (offset_ == 0) {
+      --segment_;
+      offset_ = kSegmentSize;
+    }
+    --offset_;
+    return *this;
+  }
+  SegmentIterator operator--(int) {
+    SegmentIterator copy = *this;
+    --*this;
+    return copy;
+  }
+  SegmentIterator& operator+=(difference_type n) {
+    difference_type position = offset_ + n;
+    difference_type segments = (position >= 0 ? position : position - kSegmentSize + 1) / kSegmentSize;
+    segment_ += segments;
+    offset_ = position - segments * kSegmentSize;
+    return *this;
+  }
+  SegmentIterator& operator-=(difference_type n) {
+    return *this += -n;
+  }
+  friend SegmentIterator operator+(SegmentIterator it, difference_type n) {
+    return it += n;
+  }
+  friend SegmentIterator operator+(difference_type n, SegmentIterator it) {
+    return it += n;
+  }
+  friend SegmentIterator operator-(SegmentIterator it, difference_type n) {
+    return it -= n;
+  }
+  friend difference_type operator-(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return (lhs.segment_ - rhs.segment_) * kSegmentSize + lhs.offset_ - rhs.offset_;
+  }
+  friend bool operator==(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return lhs.segment_ == rhs.segment_ && lhs.offset_ == rhs.offset_;
+  }
+  friend bool operator!=(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return !(lhs == rhs);
+  }
+  friend bool operator<(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return lhs - rhs < 0;
+  }
+  friend bool operator>(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return rhs < lhs;
+  }
+  friend bool operator<=(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return !(rhs < lhs);
+  }
+  friend bool operator>=(const SegmentIterator& lhs, const SegmentIterator& rhs) {
+    return !(lhs < rhs);
+  }
+};
+
+}  // namespace detail
+
+class ModuloBucketPolicy {
+  size_t bucket_count_ = 0;
+
+ public:
+  static size_t RoundBucketCount(size_t count) {
+    return count;
+  }
+  void Reset(size_t bucket_count) {
+    bucket_count_ = bucket_count;
+  }
+  size_t Index(size_t hash) const {
+    return hash % bucket_count_;
+  }
+};
+
+// Fibonacci hashing: the multiply spreads weak hashes (e.g. identity std::hash<int>) over the high bits.
+class PowerOfTwoBucketPolicy {
+  static constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+  unsigned shift_ = 63;
+
+ public:
+  static size_t RoundBucketCount(size_t count) {
+    if (count == 0) {
+      return 0;
+    }
+    size_t rounded = 2;
+    while (rounded < count) {
+      rounded *= 2;
+    }
+    return rounded;
+  }
+  void Reset(size_t bucket_count) {
+    shift_ = 64;
+    for (size_t i = bucket_count; i > 1; i /= 2) {
+      --shift_;
+    }
+  }
+  size_t Index(size_t hash) const {
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * kMultiplier) >> shift_);
+  }
+};
+
+// Prime bucket counts with Lemire's fastmod: the remainder of the full 64-bit hash is computed with
+// multiplications by a precomputed 128-bit inverse instead of a division.
+class FastModBucketPolicy {
+  __uint128_t multiplier_ = 0;
+  uint64_t bucket_count_ = 0;
+
+ public:
+  static size_t RoundBucketCount(size_t count) {
+    if (count <= 2) {
+      return count;
+    }
+    size_t candidate = count | 1;
+    for (;; candidate += 2) {
+      bool prime = true;
+      for (size_t d = 3; d * d <= candidate; d += 2) {
+        if (candidate % d == 0) {
+          prime = false;
+          break;
+        }
+      }
+      if (prime) {
+        return candidate;
+      }
+    }
+  }
+  void Reset(size_t bucket_count) {
+    bucket_count_ = bucket_count;
+    multiplier_ = bucket_count_ == 0 ? 0 : ~__uint128_t(0) / bucket_count_ + 1;
+  }
+  size_t Index(size_t hash) const {
+    __uint128_t low_bits = multiplier_ * static_cast<uint64_t>(hash);
+    __uint128_t bottom = (static_cast<__uint128_t>(static_cast<uint64_t>(low_bits)) * bucket_count_) >> 64;
+    __uint128_t top = static_cast<__uint128_t>(static_cast<uint64_t>(low_bits >> 64)) * bucket_count_;
+    return static_cast<size_t>((bottom + top) >> 64);
+  }
+};
+
+struct HashTableStats {
+  size_t size = 0;
+  size_t bucket_count = 0;
+  size_t bytes_allocated = 0;
+  double average_chain_length = 0;
+  double average_probe_length = 0;
+  size_t max_chain_length = 0;
+  std::vector<size_t> bucket_size_histogram;
+  size_t rehash_count = 0;
+  std::chrono::nanoseconds rehash_time{0};
+};
+
+namespace detail {  // NOLINT
+
+template <typename ValueT, typename KeyT, typename KeyOf, typename Hash, typename KeyEqual, typename BucketPolicy>
+class HashTable {
+ protected:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+  struct Link {
+    size_t hash;
+    size_t next;
+  };
+  Hash hasher_;
+  KeyEqual equal_;
+  KeyOf key_of_;
+  BucketPolicy policy_;
+  SegmentedArray<ValueT> values_;
+  SegmentedArray<Link> links_;
+  std::vector<size_t> buckets_;
+  size_t bucket_count_ = 0;
+  std::vector<size_t> next_buckets_;
+  size_t next_bucket_count_ = 0;
+  BucketPolicy old_policy_;
+  std::vector<size_t> old_buckets_;
+  size_t migrated_ = 0;
+  size_t rehash_step_ = 0;
+  bool stats_enabled_ = false;
+  size_t rehash_count_ = 0;
+  std::chrono::nanoseconds rehash_time_{0};
+  template <typename K>
+  using EnableTransparent = std::enable_if_t<IsTransparent<Hash>::value && IsTransparent<KeyEqual>::value, K>;
+  template <typename K>
+  size_t FindInChain(size_t head, const K& key, size_t h) const {
+    for (size_t i = head; i != kNone; i = links_[i].next) {
+      if (links_[i].hash == h && equal_(key_of_(values_[i]), key)) {
+        return i;
+      }
+    }
+    return kNone;
+  }
+  template <typename K>
+  size_t FindIndex(const K& key, size_t h) const {
     if (bucket_count_ == 0) {
+      return kNone;
+    }
+    size_t index = FindInChain(buckets_[policy_.Index(h)], key, h);
+    if (index == kNone && Migrating()) {
+      size_t id = old_policy_.Index(h);
+      if (id >= migrated_) {
+        index = FindInChain(old_buckets_[id], key, h);
+      }
+    }
+    return index;
+  }
+  size_t* LinkInChain(size_t* link, size_t index) {
+    while (*link != kNone && *link != index) {
+      link = &links_[*link].next;
+    }
+    return *link == index ? link : nullptr;
+  }
+  size_t* LinkTo(size_t index) {
+    size_t h = links_[index].hash;
+    size_t* link = LinkInChain(&buckets_[policy_.Index(h)], index);
+    if (link == nullptr) {
+      link = LinkInChain(&old_buckets_[old_policy_.Index(h)], index);
+    }
+    return link;
+  }
+  // the last element is moved into the hole before any chain changes, so a throwing move
+  // leaves every link pointing at a live element
+  void Unlink(size_t index) {
+    size_t last = values_.size() - 1;
+    if (index != last) {
+      values_[index] = std::move(values_[last]);
+    }
+    *LinkTo(index) = links_[index].next;
+    if (index != last) {
+      *LinkTo(last) = index;
+      links_[index] = links_[last];
+    }
+    values_.pop_back();
+    links_.pop_back();
+    MigrateStep();
+  }
+  template <typename K>
+  void EraseImpl(const K& key, size_t h) {
+    size_t index = FindIndex(key, h);
+    if (index != kNone) {
+      Unlink(index);
+    }
+  }
+  // the value is constructed first, so a throwing constructor leaves the buckets untouched
+  template <typename... Args>
+  size_t EmplaceImpl(size_t h, Args&&... args) {
+    values_.emplace_back(std::forward<Args>(args)...);
+    try {
+      if (values_.size() > bucket_count_ && !Filling()) {
+        Grow(bucket_count_ == 0 ? 1 : bucket_count_ * 2);
+      }
+      links_.push_back({h, kNone});
+    } catch (...) {
+      values_.pop_back();
+      throw;
+    }
+    size_t& head = buckets_[policy_.Index(h)];
+    links_.back().next = head;
+    head = values_.size() - 1;
+    MigrateStep();
+    return head;
+  }
+  void Grow(size_t new_bucket_count) {
+    if (rehash_step_ == 0 || links_.empty()) {
+      Rehash(new_bucket_count);
+      return;
+    }
+    FinishRehash();
+    auto start = StatsNow();
+    next_bucket_count_ = BucketPolicy::RoundBucketCount(new_bucket_count);
+    next_buckets_.reserve(next_bucket_count_);
+    RecordRehash(start, 1);
+  }
+  // Filling writes kFillPerStep new buckets per step (one cache line of heads); once the new array is
+  // complete it replaces the current one, whose chains are then relinked step buckets per operation
+  static constexpr size_t kFillPerStep = 8;
+  void MigrateStep() {
+    if (!Rehashing()) {
+      return;
+    }
+    auto start = StatsNow();
+    if (Filling()) {
+      size_t filled = next_buckets_.size();
+      filled += std::min(next_bucket_count_ - filled, kFillPerStep * rehash_step_);
+      next_buckets_.resize(filled, kNone);
+      if (filled == next_bucket_count_) {
+        old_buckets_ = std::move(buckets_);
+        old_policy_ = policy_;
+        migrated_ = 0;
+        buckets_ = std::move(next_buckets_);
+        next_buckets_ = std::vector<size_t>();
+        policy_.Reset(next_bucket_count_);
+        bucket_count_ = next_bucket_count_;
+        next_bucket_count_ = 0;
+      }
+      RecordRehash(start, 0);
       return;
     }
-    size_t h = hasher_(key);
-    std::list<KeyT>& list = buckets_[h % bucket_count_];
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      if (equal_(*it, key)) {
-        list.erase(it);
-        --size_;
-        break;
+    size_t last = std::min(old_buckets_.size(), migrated_ + rehash_step_);
+    for (; migrated_ < last; ++migrated_) {
+      for (size_t i = old_buckets_[migrated_]; i != kNone;) {
+        size_t next = links_[i].next;
+        size_t& head = buckets_[policy_.Index(links_[i].hash)];
+        links_[i].next = head;
+        head = i;
+        i = next;
       }
     }
+    if (migrated_ == old_buckets_.size()) {
+      std::vector<size_t>().swap(old_buckets_);
+      migrated_ = 0;
+    }
+    RecordRehash(start, 0);
   }
-  bool Find(const KeyT& key) const {
+  std::chrono::steady_clock::time_point StatsNow() const {
+    return stats_enabled_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+  }
+  void RecordRehash(std::chrono::steady_clock::time_point start, size_t count) {
+    if (stats_enabled_) {
+      rehash_count_ += count;
+      rehash_time_ += std::chrono::steady_clock::now() - start;
+    }
+  }
+  void AddChainStats(size_t head, HashTableStats& stats, size_t& probes) const {
+    size_t length = 0;
+    for (size_t i = head; i != kNone; i = links_[i].next) {
+      probes += ++length;
+    }
+    stats.max_chain_length = std::max(stats.max_chain_length, length);
+    if (stats.bucket_size_histogram.size() <= length) {
+      stats.bucket_size_histogram.resize(length + 1);
+    }
+    ++stats.bucket_size_histogram[length];
+  }
+  void FinishRehash() {
+    size_t step = rehash_step_;
+    rehash_step_ = std::max(next_bucket_count_, bucket_count_);
+    MigrateStep();
+    MigrateStep();
+    rehash_step_ = step;
+  }
+  bool Filling() const {
+    return next_bucket_count_ != 0;
+  }
+  bool Migrating() const {
+    return !old_buckets_.empty();
+  }
+  template <typename Iter>
+  void ReserveFor(Iter begin, Iter end) {
+    using Category = typename std::iterator_traits<Iter>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      Reserve(values_.size() + static_cast<size_t>(std::distance(begin, end)));
+    }
+  }
+
+ public:
+  HashTable() = default;
+  HashTable(const HashTable& other) = default;
+  HashTable(HashTable&& other) {
+    *this = std::move(other);
+  }
+  HashTable& operator=(const HashTable& other) {
+    if (this != &other) {
+      *this = HashTable(other);
+    }
+    return *this;
+  }
+  HashTable& operator=(HashTable&& other) {
+    hasher_ = std::move(other.hasher_);
+    equal_ = std::move(other.equal_);
+    values_ = std::move(other.values_);
+    links_ = std::move(other.links_);
+    buckets_ = std::move(other.buckets_);
+    policy_ = other.policy_;
+    bucket_count_ = other.bucket_count_;
+    next_buckets_ = std::move(other.next_buckets_);
+    next_bucket_count_ = other.next_bucket_count_;
+    old_buckets_ = std::move(other.old_buckets_);
+    old_policy_ = other.old_policy_;
+    migrated_ = other.migrated_;
+    rehash_step_ = other.rehash_step_;
+    stats_enabled_ = other.stats_enabled_;
+    rehash_count_ = other.rehash_count_;
+    rehash_time_ = other.rehash_time_;
+    other.Clear();
+    return *this;
+  }
+  ~HashTable() = default;
+  size_t Size() const {
+    return values_.size();
+  }
+  bool Empty() const {
+    return values_.empty();
+  }
+  void Clear() {
+    values_.clear();
+    links_.clear();
+    buckets_.clear();
+    next_buckets_.clear();
+    next_bucket_count_ = 0;
+    old_buckets_.clear();
+    migrated_ = 0;
+    bucket_count_ = 0;
+  }
+  void FindBatch(const KeyT* keys, size_t count, uint64_t* found) const {
+    constexpr size_t kDistance = 8;
+    constexpr size_t kWindow = 4 * kDistance;
+    std::fill(found, found + (count + 63) / 64, 0);
     if (bucket_count_ == 0) {
-      return false;
+      return;
     }
-    size_t h = hasher_(key);
-    const std::list<KeyT>& list = buckets_[h % bucket_count_];
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      if (equal_(*it, key)) {
-        return true;
+    size_t hashes[kWindow];
+    const size_t* heads[kWindow];
+    for (size_t i = 0; i < count + 2 * kDistance; ++i) {
+      if (i < count) {
+        hashes[i % kWindow] = hasher_(keys[i]);
+        heads[i % kWindow] = &buckets_[policy_.Index(hashes[i % kWindow])];
+        __builtin_prefetch(heads[i % kWindow]);
+      }
+      if (i >= kDistance && i - kDistance < count) {
+        size_t head = *heads[(i - kDistance) % kWindow];
+        if (head != kNone) {
+          __builtin_prefetch(&links_[head]);
+          __builtin_prefetch(&values_[head]);
+        }
+      }
+      if (i >= 2 * kDistance) {
+        size_t j = i - 2 * kDistance;
+        size_t index = Rehashing() ? FindIndex(keys[j], hashes[j % kWindow])
+                                   : FindInChain(*heads[j % kWindow], keys[j], hashes[j % kWindow]);
+        if (index != kNone) {
+          found[j / 64] |= uint64_t(1) << (j % 64);
+        }
       }
     }
-    return false;
   }
   void Rehash(size_t new_bucket_count) {
-    if (new_bucket_count == bucket_count_ || new_bucket_count < size_) {
+    FinishRehash();
+    new_bucket_count = BucketPolicy::RoundBucketCount(new_bucket_count);
+    if (new_bucket_count == bucket_count_ || new_bucket_count < values_.size()) {
       return;
     }
-    std::vector<std::list<KeyT> > tmp(new_bucket_count);
-    for (size_t i = 0; i < bucket_count_; ++i) {
-      std::list<KeyT>& src = buckets_[i];
-      while (src.begin() != src.end()) {
-        size_t h = hasher_(*src.begin());
-        std::list<KeyT>& dst = tmp[h % new_bucket_count];
-        dst.splice(dst.begin(), src, src.begin());
-      }
-    }
-    std::swap(buckets_, tmp);
+    auto start = StatsNow();
+    buckets_.assign(new_bucket_count, kNone);
+    policy_.Reset(new_bucket_count);
     bucket_count_ = new_bucket_count;
+    for (size_t i = 0; i < links_.size(); ++i) {
+      size_t& head = buckets_[policy_.Index(links_[i].hash)];
+      links_[i].next = head;
+      head = i;
+    }
+    RecordRehash(start, 1);
   }
-  void Reserve(size_t new_bucket_count) {
-    if (new_bucket_count <= bucket_count_) {
+  // the table grows once size exceeds the bucket count, so room for count elements needs count buckets
+  void Reserve(size_t count) {
+    if (count <= bucket_count_) {
       return;
     }
-    Rehash(new_bucket_count);
+    values_.reserve(count);
+    links_.reserve(count);
+    Rehash(count);
+  }
+  // Spreads growth over later operations: a growing insert only reserves the new bucket array, and
+  // elements never move, so no single insert touches more than a few buckets and one new segment
+  void SetRehashStep(size_t buckets_per_operation) {
+    rehash_step_ = buckets_per_operation;
+    if (rehash_step_ == 0) {
+      FinishRehash();
+    }
+  }
+  size_t RehashStep() const {
+    return rehash_step_;
+  }
+  bool Rehashing() const {
+    return Filling() || Migrating();
+  }
+  void EnableStats(bool enabled = true) {
+    stats_enabled_ = enabled;
+  }
+  HashTableStats Stats() const {
+    HashTableStats stats;
+    stats.size = values_.size();
+    stats.bucket_count = bucket_count_;
+    stats.bytes_allocated = values_.capacity() * sizeof(ValueT) + links_.capacity() * sizeof(Link) +
+                            (buckets_.capacity() + next_buckets_.capacity() + old_buckets_.capacity()) * sizeof(size_t);
+    size_t probes = 0;
+    for (size_t id = 0; id < buckets_.size(); ++id) {
+      AddChainStats(buckets_[id], stats, probes);
+    }
+    for (size_t id = migrated_; id < old_buckets_.size(); ++id) {
+      AddChainStats(old_buckets_[id], stats, probes);
+    }
+    size_t used_buckets = buckets_.size() + old_buckets_.size() - migrated_;
+    if (!stats.bucket_size_histogram.empty()) {
+      used_buckets -= stats.bucket_size_histogram[0];
+    }
+    if (used_buckets != 0) {
+      stats.average_chain_length = double(values_.size()) / used_buckets;
+    }
+    if (!values_.empty()) {
+      stats.average_probe_length = double(probes) / values_.size();
+    }
+    stats.rehash_count = rehash_count_;
+    stats.rehash_time = rehash_time_;
+    return stats;
+  }
+  Hash HashFunction() const {
+    return hasher_;
   }
   size_t BucketCount() const {
     return bucket_count_;
@@ -127,16 +719,169 @@ class UnorderedSet {
     if (id >= bucket_count_) {
       return 0;
     }
-    return buckets_[id].size();
+    size_t size = 0;
+    for (size_t i = buckets_[id]; i != kNone; i = links_[i].next) {
+      ++size;
+    }
+    return size;
   }
   size_t Bucket(const KeyT& key) const {
-    return hasher_(key) % bucket_count_;
+    return policy_.Index(hasher_(key));
   }
   double LoadFactor() const {
     if (bucket_count_ == 0) {
       return 0;
     }
-    return double(size_) / bucket_count_;
+    return double(values_.size()) / bucket_count_;
+  }
+};
+
+}  // namespace detail
+
+template <typename KeyT, typename Hash = std::hash<KeyT>, typename KeyEqual = std::equal_to<KeyT>,
+          typename BucketPolicy = ModuloBucketPolicy>
+class UnorderedSet : public detail::HashTable<KeyT, KeyT, detail::Identity, Hash, KeyEqual, BucketPolicy> {
+  using Base = detail::HashTable<KeyT, KeyT, detail::Identity, Hash, KeyEqual, BucketPolicy>;
+  template <typename K>
+  using EnableTransparent = typename Base::template EnableTransparent<K>;
+  std::optional<BlockedBloomFilter> filter_;
+  template <typename K>
+  bool FindImpl(const K& key, size_t h) const {
+    if (filter_ && !filter_->MayContain(h)) {
+      return false;
+    }
+    return this->FindIndex(key, h) != Base::kNone;
+  }
+  template <typename K>
+  void InsertImpl(K&& key, size_t h) {
+    if (filter_) {
+      filter_->Add(h);
+    }
+    this->EmplaceImpl(h, std::forward<K>(key));
+  }
+
+ public:
+  using ValueType = KeyT;
+  using DifferenceType = std::ptrdiff_t;
+  using ConstIterator = detail::SegmentIterator<KeyT, const KeyT>;
+  using Iterator = ConstIterator;
+  UnorderedSet() = default;
+  explicit UnorderedSet(size_t count) {
+    this->Rehash(count);
+  }
+  template <typename Iter>
+  UnorderedSet(const Iter& begin, const Iter& end) {
+    InsertRange(begin, end);
+  }
+  Iterator begin() {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  Iterator end() {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  ConstIterator begin() const {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  ConstIterator end() const {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  ConstIterator cbegin() const {  // NOLINT
+    return {this->values_.segments(), 0};
+  }
+  ConstIterator cend() const {  // NOLINT
+    return {this->values_.segments(), this->values_.size()};
+  }
+  void Clear() {
+    Base::Clear();
+    if (filter_) {
+      filter_->Clear();
+    }
+  }
+  void AttachFilter(size_t expected_keys, size_t bits_per_key = 10) {
+    filter_.emplace(std::max(expected_keys, this->Size()), bits_per_key);
+    for (size_t i = 0; i < this->links_.size(); ++i) {
+      filter_->Add(this->links_[i].hash);
+    }
+  }
+  void DetachFilter() {
+    filter_.reset();
+  }
+  const BlockedBloomFilter* Filter() const {
+    return filter_ ? &*filter_ : nullptr;
+  }
+  HashTableStats Stats() const {
+    HashTableStats stats = Base::Stats();
+    if (filter_) {
+      stats.bytes_allocated += filter_->MemoryUsage();
+    }
+    return stats;
+  }
+  void Insert(const KeyT& key) {
+    InsertImpl(key, this->hasher_(key));
+  }
+  void Insert(KeyT&& key) {
+    InsertImpl(std::move(key), this->hasher_(key));
+  }
+  void Insert(const KeyT& key, size_t hash) {
+    InsertImpl(key, hash);
+  }
+  void Insert(KeyT&& key, size_t hash) {
+    InsertImpl(std::move(key), hash);
+  }
+  template <typename Iter>
+  void InsertRange(Iter begin, Iter end) {
+    this->ReserveFor(begin, end);
+    for (; begin != end; ++begin) {
+      Insert(*begin);
+    }
+  }
+  template <typename Iter>
+  static UnorderedSet FromRange(Iter begin, Iter end) {
+    UnorderedSet set;
+    set.InsertRange(begin, end);
+    return set;
+  }
+  void Erase(const KeyT& key) {
+    this->EraseImpl(key, this->hasher_(key));
+  }
+  void Erase(const KeyT& key, size_t hash) {
+    this->EraseImpl(key, hash);
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  void Erase(const K& key) {
+    this->EraseImpl(key, this->hasher_(key));
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  void Erase(const K& key, size_t hash) {
+    this->EraseImpl(key, hash);
+  }
+  bool Find(const KeyT& key) const {
+    return FindImpl(key, this->hasher_(key));
+  }
+  bool Find(const KeyT& key, size_t hash) const {
+    return FindImpl(key, hash);
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  bool Find(const K& key) const {
+    return FindImpl(key, this->hasher_(key));
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  bool Find(const K& key, size_t hash) const {
+    return FindImpl(key, hash);
+  }
+  bool Contains(const KeyT& key) const {
+    return FindImpl(key, this->hasher_(key));
+  }
+  bool Contains(const KeyT& key, size_t hash) const {
+    return FindImpl(key, hash);
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  bool Contains(const K& key) const {
+    return FindImpl(key, this->hasher_(key));
+  }
+  template <typename K, typename = EnableTransparent<K> >
+  bool Contains(const K& key, size_t hash) const {
+    return FindImpl(key, hash);
   }
 };
 #endif  // UNORDERED_SET